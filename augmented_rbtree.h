@@ -0,0 +1,1696 @@
+#ifndef AUGMENTED_RBTREE_H
+#define AUGMENTED_RBTREE_H
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "node_pool.h"
+#include "tree_stats.h"
+
+/**
+ * Augmented Red-Black Tree
+ * The red-black core behind OrderStatisticTree and POMTree: a CLRS
+ * red-black tree with a nil sentinel that keeps subtree sizes in every
+ * node, plus an optional per-subtree summary folded by a monoid policy.
+ * Supports O(log n) operations for:
+ * - insert, delete, search
+ * - select (k-th smallest), rank, rankOf (lower_bound position)
+ * - fold(lo, hi): the summary of all keys in [lo, hi)
+ * - in-order iterators, lower_bound and selectRange(k1, k2) in
+ *   O(log n + k2 - k1)
+ * - selectMany / rankMany / rankOfMany: batches as interleaved descents
+ * - bulk build from sorted input in O(n)
+ * - batched insert/remove that relink the whole tree once
+ * - split (by key or rank) and join
+ *
+ * The Monoid is a compile-time policy, so its functions are inlined into
+ * rotations, fixups and path refreshes:
+ *   using Summary = ...;                          // per-subtree data
+ *   static Summary identity();                    // no elements (the sentinel's)
+ *   static Summary single(const Key&);            // or (const Key&, const Value&)
+ *   static Summary combine(const Summary& left, const Summary& right);
+ *   static bool same(const Summary&, const Summary&);
+ * An empty Summary (NoAugment) takes no space in the nodes and the tree
+ * keeps sizes only, as a plain order statistic tree.
+ *
+ * A monoid that needs per-node state of its own (a lazy tag) declares
+ * `using Tag = ...;`, stored after the links, and then also supplies
+ * pull(x, nil) to recompute x from its children, push(x, nil) to hand
+ * pending work down to them, and sameTag(a, b). The tree pushes before it
+ * reads a node's children or moves subtrees; push must not reorder keys.
+ *
+ * With `incremental` set (the default) a mutation recomputes the changed
+ * path once before the fixup, so rotations see exact children, and stops
+ * climbing at the first node whose summary and tag are unchanged.
+ * Otherwise the fixup runs first and every ancestor is recomputed.
+ *
+ * Keys are ordered by Compare (std::less<Key> by default); equivalent keys
+ * stay in insertion order. With a transparent Compare (is_transparent,
+ * e.g. std::less<>) rank, rankOf, contains and remove also take keys of
+ * other types, with no conversion to Key. Keys are passed by reference,
+ * moved in by insert(Key&&) or built in place by emplace. The sentinel
+ * holds no key at all, so Key needs no default constructor.
+ *
+ * Value is stored next to each key (void for a key-only tree). SizeT is
+ * the signed type of subtree sizes, ranks and select indices.
+ *
+ * Nodes are allocated from a NodePool slab, so teardown releases whole
+ * blocks instead of deleting nodes one at a time.
+ *
+ * Built with -DTREE_STATS, stats() reports rotations, fixup iterations,
+ * summary updates and descent depths per operation type (tree_stats.h).
+ */
+
+enum Color { RED, BLACK };
+
+// Builds the sentinel, whose key and value are never constructed or read
+struct RBSentinelTag {};
+
+// A node's key (or value) in a union, so the sentinel can leave it
+// unconstructed. It is destroyed by the tree rather than by the node,
+// and with a trivially destructible T the whole node stays trivially
+// destructible, which lets the slab release skip the teardown walk.
+template<typename T, bool Trivial = std::is_trivially_destructible<T>::value>
+struct RBKeyPart {
+    union { T key; };
+    
+    explicit RBKeyPart(RBSentinelTag) {}
+    
+    template<typename... Args>
+    explicit RBKeyPart(std::in_place_t, Args&&... args) : key(std::forward<Args>(args)...) {}
+};
+
+template<typename T>
+struct RBKeyPart<T, false> {
+    union { T key; };
+    
+    explicit RBKeyPart(RBSentinelTag) {}
+    
+    template<typename... Args>
+    explicit RBKeyPart(std::in_place_t, Args&&... args) : key(std::forward<Args>(args)...) {}
+    
+    ~RBKeyPart() {}
+};
+
+template<typename T, bool Trivial = std::is_trivially_destructible<T>::value>
+struct RBValuePart {
+    union { T value; };
+    
+    explicit RBValuePart(RBSentinelTag) {}
+    
+    template<typename... Args>
+    explicit RBValuePart(std::in_place_t, Args&&... args) : value(std::forward<Args>(args)...) {}
+};
+
+template<typename T>
+struct RBValuePart<T, false> {
+    union { T value; };
+    
+    explicit RBValuePart(RBSentinelTag) {}
+    
+    template<typename... Args>
+    explicit RBValuePart(std::in_place_t, Args&&... args) : value(std::forward<Args>(args)...) {}
+    
+    ~RBValuePart() {}
+};
+
+template<typename Summary, bool Empty = std::is_empty<Summary>::value>
+struct RBSummaryPart {
+    Summary summary;
+    
+    RBSummaryPart() : summary() {}
+};
+
+template<typename Summary>
+struct RBSummaryPart<Summary, true> {};
+
+// Key, value and summary of a node; a void value or empty summary takes
+// no space
+template<typename Key, typename Value, typename Summary, bool HasValue = !std::is_void<Value>::value>
+struct RBPayload : RBKeyPart<Key>, RBValuePart<Value>, RBSummaryPart<Summary> {
+    explicit RBPayload(RBSentinelTag t) : RBKeyPart<Key>(t), RBValuePart<Value>(t) {}
+    
+    // The key from the first argument, the value from the rest
+    template<typename K, typename... Args>
+    RBPayload(std::in_place_t, K&& key, Args&&... args)
+        : RBKeyPart<Key>(std::in_place, std::forward<K>(key)),
+          RBValuePart<Value>(std::in_place, std::forward<Args>(args)...) {}
+};
+
+template<typename Key, typename Value, typename Summary>
+struct RBPayload<Key, Value, Summary, false> : RBKeyPart<Key>, RBSummaryPart<Summary> {
+    explicit RBPayload(RBSentinelTag t) : RBKeyPart<Key>(t) {}
+    
+    // The key from all arguments
+    template<typename... Args>
+    explicit RBPayload(std::in_place_t, Args&&... args)
+        : RBKeyPart<Key>(std::in_place, std::forward<Args>(args)...) {}
+};
+
+template<typename Payload, typename Tag, typename SizeT>
+struct RBNode : Payload {
+    Color color;
+    SizeT size;  // Size of subtree rooted at this node
+    RBNode* left;
+    RBNode* right;
+    RBNode* parent;
+    Tag tag;     // The monoid's own state, kept after the hot fields
+    
+    template<typename... Args>
+    explicit RBNode(Args&&... args)
+        : Payload(std::forward<Args>(args)...), color(RED), size(1),
+          left(nullptr), right(nullptr), parent(nullptr), tag() {}
+};
+
+template<typename Payload, typename SizeT>
+struct RBNode<Payload, void, SizeT> : Payload {
+    Color color;
+    SizeT size;  // Size of subtree rooted at this node
+    RBNode* left;
+    RBNode* right;
+    RBNode* parent;
+    
+    template<typename... Args>
+    explicit RBNode(Args&&... args)
+        : Payload(std::forward<Args>(args)...), color(RED), size(1),
+          left(nullptr), right(nullptr), parent(nullptr) {}
+};
+
+// Compare::is_transparent, as std::set uses for heterogeneous lookup
+template<typename Compare, typename = void>
+struct RBIsTransparent : std::false_type {};
+
+template<typename Compare>
+struct RBIsTransparent<Compare, std::void_t<typename Compare::is_transparent>> : std::true_type {};
+
+// Monoid::Tag if the policy declares one, else void
+template<typename Monoid, typename = void>
+struct RBMonoidTag {
+    using type = void;
+};
+
+template<typename Monoid>
+struct RBMonoidTag<Monoid, std::void_t<typename Monoid::Tag>> {
+    using type = typename Monoid::Tag;
+};
+
+// No summary: the tree keeps subtree sizes only
+struct NoAugment {
+    struct Summary {};
+};
+
+// Sum of the values stored in each subtree, e.g.
+// AugmentedRBTree<int, long long, SumMonoid<long long>> for weighted keys
+template<typename T>
+struct SumMonoid {
+    using Summary = T;
+    
+    static T identity() { return T(); }
+    
+    template<typename Key>
+    static T single(const Key&, const T& value) { return value; }
+    
+    static T combine(const T& left, const T& right) { return left + right; }
+    static bool same(const T& a, const T& b) { return a == b; }
+};
+
+template<typename Key, typename Value, typename Monoid, typename SizeT = int,
+         typename Compare = std::less<Key>>
+class AugmentedRBTree {
+    static_assert(std::is_signed<SizeT>::value, "SizeT must be signed (rank returns -1)");
+
+public:
+    using Summary = typename Monoid::Summary;
+    using Tag = typename RBMonoidTag<Monoid>::type;
+    using Node = RBNode<RBPayload<Key, Value, Summary>, Tag, SizeT>;
+    using value_type = Key;
+    using mapped_type = Value;
+    using size_type = SizeT;
+    using key_compare = Compare;
+
+protected:
+    static constexpr bool hasValue = !std::is_void<Value>::value;
+    static constexpr bool hasSummary = !std::is_empty<Summary>::value;
+    static constexpr bool hasTag = !std::is_void<Tag>::value;
+    static_assert(hasSummary || !hasTag, "a Tag needs a Summary to act on");
+    
+    // What bulk operations take: keys, or (key, value) pairs
+    using Element = typename std::conditional<hasValue, std::pair<Key, Value>, Key>::type;
+    
+    // Heterogeneous lookups take any K when Compare is transparent
+    template<typename K>
+    using IfTransparent = typename std::enable_if<RBIsTransparent<Compare>::value &&
+                                                  !std::is_same<K, Key>::value, int>::type;
+    
+    std::shared_ptr<NodePool<Node>> pool;  // Shared with split-off trees
+    Node* root;
+    Node* nil;         // Sentinel node (shared along with the pool)
+    Monoid monoid;     // Policy state, if any; split-off trees get a copy
+    Compare comp;      // Key order; split-off trees get a copy
+    bool incremental;  // Path refresh mode (see above)
+
+#ifdef TREE_STATS
+    mutable TreeStats treeStats;
+#endif
+    
+    static const Key& keyOf(const Element& e) {
+        if constexpr (hasValue) {
+            return e.first;
+        } else {
+            return e;
+        }
+    }
+    
+    static Summary singleOf(const Node* x) {
+        if constexpr (hasValue) {
+            return Monoid::single(x->key, x->value);
+        } else {
+            return Monoid::single(x->key);
+        }
+    }
+    
+    // Neither key orders before the other
+    template<typename A, typename B>
+    bool equivalent(const A& a, const B& b) const {
+        return !comp(a, b) && !comp(b, a);
+    }
+    
+    // Build a node in place: the key from args (for a tree with values,
+    // the key from the first argument and the value from the rest)
+    template<typename... Args>
+    Node* createNode(Args&&... args) {
+        Node* x = pool->create(std::in_place, std::forward<Args>(args)...);
+        if constexpr (hasSummary) {
+            x->summary = singleOf(x);
+        }
+        return x;
+    }
+    
+    template<typename E>
+    Node* createFrom(E&& e) {
+        if constexpr (hasValue) {
+            return createNode(std::forward<E>(e).first, std::forward<E>(e).second);
+        } else {
+            return createNode(std::forward<E>(e));
+        }
+    }
+    
+    Node* copyNode(const Node* x) {
+        if constexpr (hasValue) {
+            return createNode(x->key, x->value);
+        } else {
+            return createNode(x->key);
+        }
+    }
+    
+    // Destroy a node's key and value (the node itself leaves them alone,
+    // since the sentinel never has them) and return it to the pool
+    void destroyNode(Node* x) {
+        if constexpr (!std::is_trivially_destructible<Key>::value) {
+            x->key.~Key();
+        }
+        if constexpr (hasValue) {
+            if constexpr (!std::is_trivially_destructible<Value>::value) {
+                x->value.~Value();
+            }
+        }
+        pool->destroy(x);
+    }
+    
+    // Hand x's pending tag to its children
+    void push(Node* x) {
+        if constexpr (hasTag) {
+            monoid.push(x, nil);
+        }
+    }
+    
+    // Push every pending tag on the path from the root down to x
+    void pushPath(Node* x) {
+        if (x == nil) return;
+        pushPath(x->parent);
+        push(x);
+    }
+    
+    // Recompute x's summary from its children
+    void pull(Node* x) {
+        if constexpr (hasSummary) {
+            if (x == nil) return;
+            TREE_STATS_COUNT(augmentUpdates);
+            if constexpr (hasTag) {
+                monoid.pull(x, nil);
+            } else {
+                // left subtree, then the node itself, then right subtree
+                // (the sentinel carries the identity, so nil children need no checks)
+                x->summary = Monoid::combine(Monoid::combine(x->left->summary, singleOf(x)),
+                                             x->right->summary);
+            }
+        }
+    }
+    
+    // Recompute x's size and summary from its children
+    void refresh(Node* x) {
+        if constexpr (!hasSummary) {
+            TREE_STATS_COUNT(augmentUpdates);
+        }
+        x->size = x->left->size + x->right->size + 1;
+        pull(x);
+    }
+    
+    // Everything a parent reads from a child when it is recomputed
+    struct State {
+        Summary summary;
+        typename std::conditional<hasTag, Tag, char>::type tag;
+    };
+    
+    State stateOf(const Node* x) const {
+        State s;
+        s.summary = x->summary;
+        if constexpr (hasTag) {
+            s.tag = x->tag;
+        }
+        return s;
+    }
+    
+    bool sameState(const State& a, const State& b) const {
+        if constexpr (hasTag) {
+            return Monoid::same(a.summary, b.summary) && monoid.sameTag(a.tag, b.tag);
+        } else {
+            return Monoid::same(a.summary, b.summary);
+        }
+    }
+    
+    void leftRotate(Node* x) {
+        TREE_STATS_COUNT(leftRotations);
+        Node* y = x->right;
+        push(x);
+        push(y);
+        x->right = y->left;
+        
+        if (y->left != nil) {
+            y->left->parent = x;
+        }
+        
+        y->parent = x->parent;
+        
+        if (x->parent == nil) {
+            root = y;
+        } else if (x == x->parent->left) {
+            x->parent->left = y;
+        } else {
+            x->parent->right = y;
+        }
+        
+        y->left = x;
+        x->parent = y;
+        
+        // Update sizes and summaries, lower node first
+        y->size = x->size;
+        x->size = x->left->size + x->right->size + 1;
+        pull(x);
+        pull(y);
+    }
+    
+    void rightRotate(Node* y) {
+        TREE_STATS_COUNT(rightRotations);
+        Node* x = y->left;
+        push(y);
+        push(x);
+        y->left = x->right;
+        
+        if (x->right != nil) {
+            x->right->parent = y;
+        }
+        
+        x->parent = y->parent;
+        
+        if (y->parent == nil) {
+            root = x;
+        } else if (y == y->parent->right) {
+            y->parent->right = x;
+        } else {
+            y->parent->left = x;
+        }
+        
+        x->right = y;
+        y->parent = x;
+        
+        // Update sizes and summaries, lower node first
+        x->size = y->size;
+        y->size = y->left->size + y->right->size + 1;
+        pull(y);
+        pull(x);
+    }
+    
+    // Returns true if the root was red and had to be blackened, i.e. the
+    // black height of the tree grew by one
+    bool insertFixup(Node* z) {
+        while (z->parent->color == RED) {
+            TREE_STATS_COUNT(insertFixupIterations);
+            if (z->parent == z->parent->parent->left) {
+                Node* y = z->parent->parent->right;
+                if (y->color == RED) {
+                    z->parent->color = BLACK;
+                    y->color = BLACK;
+                    z->parent->parent->color = RED;
+                    z = z->parent->parent;
+                } else {
+                    if (z == z->parent->right) {
+                        z = z->parent;
+                        leftRotate(z);
+                    }
+                    z->parent->color = BLACK;
+                    z->parent->parent->color = RED;
+                    rightRotate(z->parent->parent);
+                }
+            } else {
+                Node* y = z->parent->parent->left;
+                if (y->color == RED) {
+                    z->parent->color = BLACK;
+                    y->color = BLACK;
+                    z->parent->parent->color = RED;
+                    z = z->parent->parent;
+                } else {
+                    if (z == z->parent->left) {
+                        z = z->parent;
+                        rightRotate(z);
+                    }
+                    z->parent->color = BLACK;
+                    z->parent->parent->color = RED;
+                    leftRotate(z->parent->parent);
+                }
+            }
+        }
+        bool grew = (root->color == RED);
+        root->color = BLACK;
+        return grew;
+    }
+    
+    void transplant(Node* u, Node* v) {
+        if (u->parent == nil) {
+            root = v;
+        } else if (u == u->parent->left) {
+            u->parent->left = v;
+        } else {
+            u->parent->right = v;
+        }
+        v->parent = u->parent;
+    }
+    
+    Node* minimum(Node* x) {
+        while (x->left != nil) {
+            x = x->left;
+        }
+        return x;
+    }
+    
+    Node* maximum(Node* x) {
+        while (x->right != nil) {
+            x = x->right;
+        }
+        return x;
+    }
+    
+    Node* successor(Node* x) {
+        if (x->right != nil) return minimum(x->right);
+        Node* y = x->parent;
+        while (y != nil && x == y->right) {
+            x = y;
+            y = y->parent;
+        }
+        return y;
+    }
+    
+    // In-order steps for iterators. Each node is pushed before its children
+    // are read, so every node reached from the root has no pending tag above
+    // it and its key is current.
+    Node* firstNode(Node* x) {
+        if (x == nil) return nil;
+        push(x);
+        while (x->left != nil) {
+            x = x->left;
+            push(x);
+        }
+        return x;
+    }
+    
+    Node* lastNode(Node* x) {
+        if (x == nil) return nil;
+        push(x);
+        while (x->right != nil) {
+            x = x->right;
+            push(x);
+        }
+        return x;
+    }
+    
+    Node* nextNode(Node* x) {
+        if (x->right != nil) return firstNode(x->right);
+        Node* y = x->parent;
+        while (y != nil && x == y->right) {
+            x = y;
+            y = y->parent;
+        }
+        return y;
+    }
+    
+    Node* prevNode(Node* x) {
+        if (x->left != nil) return lastNode(x->left);
+        Node* y = x->parent;
+        while (y != nil && x == y->left) {
+            x = y;
+            y = y->parent;
+        }
+        return y;
+    }
+    
+    void deleteFixup(Node* x) {
+        while (x != root && x->color == BLACK) {
+            TREE_STATS_COUNT(deleteFixupIterations);
+            if (x == x->parent->left) {
+                Node* w = x->parent->right;
+                if (w->color == RED) {
+                    w->color = BLACK;
+                    x->parent->color = RED;
+                    leftRotate(x->parent);
+                    w = x->parent->right;
+                }
+                if (w->left->color == BLACK && w->right->color == BLACK) {
+                    w->color = RED;
+                    x = x->parent;
+                } else {
+                    if (w->right->color == BLACK) {
+                        w->left->color = BLACK;
+                        w->color = RED;
+                        rightRotate(w);
+                        w = x->parent->right;
+                    }
+                    w->color = x->parent->color;
+                    x->parent->color = BLACK;
+                    w->right->color = BLACK;
+                    leftRotate(x->parent);
+                    x = root;
+                }
+            } else {
+                Node* w = x->parent->left;
+                if (w->color == RED) {
+                    w->color = BLACK;
+                    x->parent->color = RED;
+                    rightRotate(x->parent);
+                    w = x->parent->left;
+                }
+                if (w->right->color == BLACK && w->left->color == BLACK) {
+                    w->color = RED;
+                    x = x->parent;
+                } else {
+                    if (w->left->color == BLACK) {
+                        w->right->color = BLACK;
+                        w->color = RED;
+                        leftRotate(w);
+                        w = x->parent->left;
+                    }
+                    w->color = x->parent->color;
+                    x->parent->color = BLACK;
+                    w->left->color = BLACK;
+                    rightRotate(x->parent);
+                    x = root;
+                }
+            }
+        }
+        x->color = BLACK;
+    }
+    
+    void updateAncestors(Node* node) {
+        while (node != nil) {
+            pull(node);
+            node = node->parent;
+        }
+    }
+    
+    // Recompute from node upwards, stopping before `stop` or as soon as a
+    // node's state is unchanged: everything above it then sees the same
+    // inputs as before. Returns false if it stopped early.
+    bool refreshPath(Node* node, Node* stop) {
+        while (node != stop) {
+            State old = stateOf(node);
+            pull(node);
+            if (sameState(old, stateOf(node))) return false;
+            node = node->parent;
+        }
+        return true;
+    }
+    
+    // Return every node of a subtree to the pool
+    void destroyNodes(Node* node) {
+        if (node == nil) return;
+        std::vector<Node*> stack(1, node);
+        while (!stack.empty()) {
+            Node* x = stack.back();
+            stack.pop_back();
+            if (x->left != nil) stack.push_back(x->left);
+            if (x->right != nil) stack.push_back(x->right);
+            destroyNode(x);
+        }
+    }
+    
+    // Link nodes[lo, hi), already in key order, into a perfectly balanced
+    // subtree, computing each summary once from its finished children.
+    // Only nodes on an incomplete deepest level are red, so every
+    // root-to-leaf path has the same black height.
+    Node* linkBalanced(std::vector<Node*>& nodes, std::size_t lo, std::size_t hi,
+                       Node* parent, int depth, int redDepth) {
+        if (lo == hi) return nil;
+        
+        std::size_t mid = lo + (hi - lo) / 2;
+        Node* x = nodes[mid];
+        x->parent = parent;
+        x->left = linkBalanced(nodes, lo, mid, x, depth + 1, redDepth);
+        x->right = linkBalanced(nodes, mid + 1, hi, x, depth + 1, redDepth);
+        x->color = (depth == redDepth) ? RED : BLACK;
+        x->size = static_cast<SizeT>(hi - lo);
+        pull(x);
+        return x;
+    }
+    
+    void initSentinel() {
+        pool = std::make_shared<NodePool<Node>>();
+        nil = pool->create(RBSentinelTag());
+        nil->color = BLACK;
+        nil->size = 0;
+        nil->left = nil->right = nil->parent = nil;
+        if constexpr (hasSummary) {
+            nil->summary = Monoid::identity();
+        }
+        root = nil;
+    }
+    
+    void linkAll(std::vector<Node*>& nodes) {
+        std::size_t n = nodes.size();
+        int redDepth = -1;
+        if (((n + 1) & n) != 0) {
+            // Deepest level floor(log2 n) is only partially filled
+            redDepth = 0;
+            while ((n >> (redDepth + 1)) != 0) redDepth++;
+        }
+        root = linkBalanced(nodes, 0, n, nil, 0, redDepth);
+        root->color = BLACK;
+    }
+    
+    // Append the nodes of subtree x to out in key order, pushing every
+    // pending tag so the collected elements are exact
+    void collectInOrder(Node* x, std::vector<Node*>& out) {
+        std::vector<Node*> stack;
+        while (x != nil || !stack.empty()) {
+            while (x != nil) {
+                push(x);
+                stack.push_back(x);
+                x = x->left;
+            }
+            x = stack.back();
+            stack.pop_back();
+            out.push_back(x);
+            x = x->right;
+        }
+    }
+    
+    // Number of black nodes on any path from x down to (excluding) nil
+    int blackHeight(Node* x) {
+        int h = 0;
+        for (; x != nil; x = x->left) {
+            if (x->color == BLACK) h++;
+        }
+        return h;
+    }
+    
+    // Join detached subtrees l < pivot < r with black heights hl and hr
+    // (both counting their root if black). Descends the taller tree's spine
+    // only as far as the shorter tree's height, so it costs O(|hl - hr| + 1).
+    // Returns the new subtree root and stores its black height in h.
+    Node* joinNodes(Node* l, int hl, Node* pivot, Node* r, int hr, int& h) {
+        if (l->color == RED) { l->color = BLACK; hl++; }
+        if (r->color == RED) { r->color = BLACK; hr++; }
+        
+        if (hl == hr) {
+            pivot->left = l;
+            pivot->right = r;
+            pivot->parent = nil;
+            l->parent = r->parent = pivot;
+            pivot->color = BLACK;
+            refresh(pivot);
+            h = hl + 1;
+            return pivot;
+        }
+        
+        Node* top = (hl > hr) ? l : r;
+        int hTop = (hl > hr) ? hl : hr;
+        int hTarget = (hl > hr) ? hr : hl;
+        
+        // Walk the inner spine to the first black node of height hTarget
+        Node* c = top;
+        Node* p = nil;
+        int hc = hTop;
+        while (!(c->color == BLACK && hc == hTarget)) {
+            if (c->color == BLACK) hc--;
+            push(c);
+            p = c;
+            c = (hl > hr) ? c->right : c->left;
+        }
+        
+        if (hl > hr) {
+            pivot->left = c;
+            pivot->right = r;
+            p->right = pivot;
+        } else {
+            pivot->left = l;
+            pivot->right = c;
+            p->left = pivot;
+        }
+        pivot->parent = p;
+        pivot->left->parent = pivot;
+        pivot->right->parent = pivot;
+        pivot->color = RED;
+        
+        for (Node* a = pivot; a != nil; a = a->parent) {
+            refresh(a);
+        }
+        
+        root = top;
+        h = hTop + (insertFixup(pivot) ? 1 : 0);
+        return root;
+    }
+    
+    // Split detached subtree t (black height ht) into keys < key and
+    // keys >= key. Each level joins onto the pieces found below it; the
+    // join costs telescope, so the whole split is O(log n).
+    void splitNodes(Node* t, int ht, const Key& key, Node*& l, int& hl, Node*& r, int& hr) {
+        if (t == nil) {
+            l = r = nil;
+            hl = hr = 0;
+            return;
+        }
+        int hc = ht - (t->color == BLACK ? 1 : 0);
+        push(t);
+        Node* a = t->left;
+        Node* b = t->right;
+        a->parent = b->parent = nil;
+        
+        if (!comp(t->key, key)) {
+            Node* mid;
+            int hMid;
+            splitNodes(a, hc, key, l, hl, mid, hMid);
+            r = joinNodes(mid, hMid, t, b, hc, hr);
+        } else {
+            Node* mid;
+            int hMid;
+            splitNodes(b, hc, key, mid, hMid, r, hr);
+            l = joinNodes(a, hc, t, mid, hMid, hl);
+        }
+    }
+    
+    // Split detached subtree t into its first k elements and the rest
+    void splitNodesByRank(Node* t, int ht, SizeT k, Node*& l, int& hl, Node*& r, int& hr) {
+        if (t == nil) {
+            l = r = nil;
+            hl = hr = 0;
+            return;
+        }
+        int hc = ht - (t->color == BLACK ? 1 : 0);
+        push(t);
+        Node* a = t->left;
+        Node* b = t->right;
+        SizeT leftSize = a->size;
+        a->parent = b->parent = nil;
+        
+        if (k <= leftSize) {
+            Node* mid;
+            int hMid;
+            splitNodesByRank(a, hc, k, l, hl, mid, hMid);
+            r = joinNodes(mid, hMid, t, b, hc, hr);
+        } else {
+            Node* mid;
+            int hMid;
+            splitNodesByRank(b, hc, k - leftSize - 1, mid, hMid, r, hr);
+            l = joinNodes(a, hc, t, mid, hMid, hl);
+        }
+    }
+    
+    // A tree over another tree's pool and sentinel (used by split)
+    AugmentedRBTree(std::shared_ptr<NodePool<Node>> sharedPool, Node* sharedNil,
+                    Node* subtree, const Monoid& monoid, const Compare& comp, bool incremental)
+        : pool(std::move(sharedPool)), root(subtree), nil(sharedNil),
+          monoid(monoid), comp(comp), incremental(incremental) {
+        root->parent = nil;
+    }
+    
+    // Relinking all n + k nodes costs O(n + k); k separate updates cost
+    // O(k log(n + k)). Pick whichever is cheaper for this batch.
+    static bool preferRebuild(std::size_t n, std::size_t k) {
+        std::size_t depth = 1;
+        while (((n + k) >> depth) != 0) depth++;
+        return k * depth >= n + k;
+    }
+    
+    // Descend from the root to z's place and link it in as a red leaf,
+    // then rebalance and refresh the summaries on its path
+    Node* insertNode(Node* z) {
+        z->left = z->right = nil;
+        
+        Node* y = nil;
+        Node* x = root;
+        
+        while (x != nil) {
+            TREE_STATS_COUNT(nodesVisited);
+            push(x);
+            y = x;
+            x->size++;  // Increment size along the path
+            if (comp(z->key, x->key)) {
+                x = x->left;
+            } else {
+                x = x->right;
+            }
+        }
+        
+        z->parent = y;
+        
+        if (y == nil) {
+            root = z;
+        } else if (comp(z->key, y->key)) {
+            y->left = z;
+        } else {
+            y->right = z;
+        }
+        
+        z->color = RED;
+        if constexpr (hasSummary) {
+            if (incremental) {
+                refreshPath(y, nil);
+                insertFixup(z);
+            } else {
+                insertFixup(z);
+                updateAncestors(z);
+            }
+        } else {
+            insertFixup(z);
+        }
+        return z;
+    }
+    
+    // Detach node z from the tree and rebalance; z itself is not freed
+    void unlinkNode(Node* z) {
+        if constexpr (hasTag) {
+            // Nodes on both paths get recomputed, so settle their tags first
+            pushPath(z);
+            if (z->left != nil && z->right != nil) {
+                for (Node* p = z->right; p != nil; p = p->left) {
+                    push(p);
+                }
+            }
+        }
+        
+        // Decrement sizes along path from z to root
+        for (Node* p = z; p != nil; p = p->parent) {
+            p->size--;
+        }
+        
+        Node* updateStart = z->parent;
+        Node* moved = nil;  // Successor that takes z's place, if any
+        
+        Node* y = z;
+        Node* x;
+        Color yOriginalColor = y->color;
+        
+        if (z->left == nil) {
+            x = z->right;
+            transplant(z, z->right);
+        } else if (z->right == nil) {
+            x = z->left;
+            transplant(z, z->left);
+        } else {
+            y = minimum(z->right);
+            yOriginalColor = y->color;
+            x = y->right;
+            updateStart = y->parent;
+            
+            if (y->parent == z) {
+                x->parent = y;
+                updateStart = y;
+            } else {
+                // Decrement sizes from y to z
+                for (Node* p = y->parent; p != z; p = p->parent) {
+                    p->size--;
+                }
+                transplant(y, y->right);
+                y->right = z->right;
+                y->right->parent = y;
+            }
+            
+            transplant(z, y);
+            y->left = z->left;
+            y->left->parent = y;
+            y->color = z->color;
+            y->size = y->left->size + y->right->size + 1;
+            moved = y;
+        }
+        
+        if constexpr (hasSummary) {
+            if (incremental) {
+                if (moved != nil) {
+                    // Nodes between the successor's old spot and its new one
+                    // lost it; it then stands where z was, so compare with z
+                    refreshPath(updateStart, moved);
+                    pull(moved);
+                    if (!sameState(stateOf(z), stateOf(moved))) {
+                        refreshPath(moved->parent, nil);
+                    }
+                } else {
+                    refreshPath(updateStart, nil);
+                }
+                if (yOriginalColor == BLACK) {
+                    deleteFixup(x);
+                }
+            } else {
+                if (yOriginalColor == BLACK) {
+                    deleteFixup(x);
+                }
+                updateAncestors(updateStart);
+            }
+        } else {
+            (void)updateStart;
+            if (yOriginalColor == BLACK) {
+                deleteFixup(x);
+            }
+        }
+    }
+    
+    template<typename K>
+    Node* search(Node* x, const K& key) {
+        while (x != nil) {
+            bool less = comp(key, x->key);
+            if (!less && !comp(x->key, key)) break;
+            TREE_STATS_COUNT(nodesVisited);
+            if (less) {
+                x = x->left;
+            } else {
+                x = x->right;
+            }
+        }
+        return x;
+    }
+    
+    // Single top-down pass; the sentinel's size of 0 stands in for
+    // empty subtrees, so no nil checks on the children are needed
+    Node* selectNode(Node* x, SizeT k) {
+        while (x != nil) {
+            TREE_STATS_COUNT(nodesVisited);
+            push(x);
+            SizeT r = x->left->size + 1;
+            if (k == r) {
+                return x;
+            } else if (k < r) {
+                x = x->left;
+            } else {
+                k -= r;
+                x = x->right;
+            }
+        }
+        return nil;
+    }
+    
+    // Summary of the keys >= lo in subtree x.
+    // Pieces are found right-to-left along one downward path.
+    Summary suffixFrom(Node* x, const Key& lo) {
+        Summary acc = Monoid::identity();
+        while (x != nil) {
+            TREE_STATS_COUNT(nodesVisited);
+            push(x);
+            if (!comp(x->key, lo)) {
+                acc = Monoid::combine(Monoid::combine(singleOf(x), x->right->summary), acc);
+                x = x->left;
+            } else {
+                x = x->right;
+            }
+        }
+        return acc;
+    }
+    
+    // Summary of the keys < hi in subtree x.
+    // Pieces are found left-to-right along one downward path.
+    Summary prefixBefore(Node* x, const Key& hi) {
+        Summary acc = Monoid::identity();
+        while (x != nil) {
+            TREE_STATS_COUNT(nodesVisited);
+            push(x);
+            if (comp(x->key, hi)) {
+                acc = Monoid::combine(acc, Monoid::combine(x->left->summary, singleOf(x)));
+                x = x->right;
+            } else {
+                x = x->left;
+            }
+        }
+        return acc;
+    }
+    
+    template<typename K>
+    SizeT rankImpl(const K& key) {
+        TREE_STATS_SCOPE(TREE_OP_RANK);
+        SizeT r = 0;
+        Node* x = root;
+        while (x != nil) {
+            TREE_STATS_COUNT(nodesVisited);
+            if (comp(key, x->key)) {
+                x = x->left;
+            } else if (comp(x->key, key)) {
+                r += x->left->size + 1;
+                x = x->right;
+            } else {
+                return r + x->left->size + 1;
+            }
+        }
+        return -1;
+    }
+    
+    template<typename K>
+    SizeT rankOfImpl(const K& key) {
+        TREE_STATS_SCOPE(TREE_OP_RANK);
+        SizeT less = 0;
+        Node* x = root;
+        while (x != nil) {
+            TREE_STATS_COUNT(nodesVisited);
+            if (comp(x->key, key)) {
+                less += x->left->size + 1;
+                x = x->right;
+            } else {
+                x = x->left;
+            }
+        }
+        return less + 1;
+    }
+    
+    template<typename K>
+    void removeImpl(const K& key) {
+        TREE_STATS_SCOPE(TREE_OP_REMOVE);
+        Node* z = search(root, key);
+        if (z == nil) return;
+        
+        unlinkNode(z);
+        destroyNode(z);
+    }
+    
+    // First node whose key is not less than key, or nil
+    template<typename K>
+    Node* lowerBoundNode(const K& key) {
+        TREE_STATS_SCOPE(TREE_OP_RANK);
+        Node* found = nil;
+        Node* x = root;
+        while (x != nil) {
+            TREE_STATS_COUNT(nodesVisited);
+            push(x);
+            if (comp(x->key, key)) {
+                x = x->right;
+            } else {
+                found = x;
+                x = x->left;
+            }
+        }
+        return found;
+    }
+    
+    // Batched descents run this many lanes in lockstep (see selectMany)
+    static constexpr int BATCH_LANES = 16;
+    
+    // found[j] = the node of rank ranks[j], for j < lanes. Each round moves
+    // every unfinished lane one level down and prefetches the node it lands
+    // on, so up to BATCH_LANES cache misses are in flight at once instead of
+    // one per dependent descent.
+    void selectLanes(const SizeT* ranks, int lanes, Node** found) {
+        Node* x[BATCH_LANES];
+        SizeT k[BATCH_LANES];
+        for (int j = 0; j < lanes; j++) {
+            x[j] = root;
+            k[j] = ranks[j];
+        }
+        int active = lanes;
+        while (active > 0) {
+            for (int j = 0; j < lanes; j++) {
+                Node* y = x[j];
+                if (y == nil) continue;
+                TREE_STATS_COUNT(nodesVisited);
+                push(y);
+                SizeT r = y->left->size + 1;
+                if (k[j] == r) {
+                    found[j] = y;
+                    x[j] = nil;
+                    active--;
+                    continue;
+                }
+                if (k[j] < r) {
+                    y = y->left;
+                } else {
+                    k[j] -= r;
+                    y = y->right;
+                }
+                __builtin_prefetch(y);
+                x[j] = y;
+            }
+        }
+    }
+    
+    // out[j] = rank(keys[j]) when exact, else rankOf(keys[j]), in the same
+    // lockstep lanes as selectLanes
+    void rankLanes(const Key* keys, int lanes, bool exact, SizeT* out) {
+        if (root == nil) {
+            std::fill(out, out + lanes, exact ? SizeT(-1) : SizeT(1));
+            return;
+        }
+        Node* x[BATCH_LANES];
+        for (int j = 0; j < lanes; j++) {
+            x[j] = root;
+            out[j] = 0;
+        }
+        int active = lanes;
+        while (active > 0) {
+            for (int j = 0; j < lanes; j++) {
+                Node* y = x[j];
+                if (y == nil) continue;
+                TREE_STATS_COUNT(nodesVisited);
+                if (comp(keys[j], y->key)) {
+                    y = y->left;
+                } else if (comp(y->key, keys[j])) {
+                    out[j] += y->left->size + 1;
+                    y = y->right;
+                } else if (exact) {
+                    out[j] += y->left->size + 1;
+                    x[j] = nil;
+                    active--;
+                    continue;
+                } else {
+                    y = y->left;  // rankOf counts only smaller keys
+                }
+                if (y == nil) {
+                    out[j] = exact ? SizeT(-1) : out[j] + 1;
+                    active--;
+                } else {
+                    __builtin_prefetch(y);
+                }
+                x[j] = y;
+            }
+        }
+    }
+    
+    std::vector<SizeT> rankManyImpl(const std::vector<Key>& keys, bool exact) {
+        TREE_STATS_SCOPE(TREE_OP_RANK);
+        std::vector<SizeT> out(keys.size());
+        for (std::size_t i = 0; i < keys.size(); i += BATCH_LANES) {
+            int lanes = static_cast<int>(std::min<std::size_t>(BATCH_LANES, keys.size() - i));
+            rankLanes(keys.data() + i, lanes, exact, out.data() + i);
+        }
+        return out;
+    }
+
+public:
+    // Bidirectional in-order iterator over the keys. Iterators stay valid
+    // while other elements are inserted or removed (nodes never move), but
+    // a lazy range update such as POMTree::addRange invalidates them.
+    class const_iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = Key;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Key*;
+        using reference = const Key&;
+        
+        const_iterator() : tree(nullptr), node(nullptr) {}
+        
+        reference operator*() const { return node->key; }
+        pointer operator->() const { return &node->key; }
+        
+        // The value stored next to the key (trees with a Value only)
+        template<typename V = Value>
+        const V& value() const { return node->value; }
+        
+        const_iterator& operator++() {
+            node = tree->nextNode(node);
+            return *this;
+        }
+        
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+        
+        // Decrementing end() yields the largest element
+        const_iterator& operator--() {
+            node = (node == tree->nil) ? tree->lastNode(tree->root) : tree->prevNode(node);
+            return *this;
+        }
+        
+        const_iterator operator--(int) {
+            const_iterator old = *this;
+            --*this;
+            return old;
+        }
+        
+        bool operator==(const const_iterator& other) const { return node == other.node; }
+        bool operator!=(const const_iterator& other) const { return node != other.node; }
+    
+    private:
+        friend class AugmentedRBTree;
+        
+        const_iterator(AugmentedRBTree* tree, Node* node) : tree(tree), node(node) {}
+        
+        AugmentedRBTree* tree;
+        Node* node;
+    };
+    using iterator = const_iterator;
+    
+    explicit AugmentedRBTree(const Compare& comp = Compare()) : comp(comp), incremental(true) {
+        initSentinel();
+    }
+    
+    // Build from a range that is already sorted, in O(n)
+    template<typename InputIt,
+             typename = typename std::iterator_traits<InputIt>::iterator_category>
+    AugmentedRBTree(InputIt first, InputIt last, const Compare& comp = Compare())
+        : AugmentedRBTree(comp) {
+        buildFromSorted(first, last);
+    }
+    
+    AugmentedRBTree(const AugmentedRBTree&) = delete;
+    AugmentedRBTree& operator=(const AugmentedRBTree&) = delete;
+    
+    // The moved-from tree is left empty, still sharing the pool
+    AugmentedRBTree(AugmentedRBTree&& other) noexcept
+        : pool(other.pool), root(other.root), nil(other.nil),
+          monoid(other.monoid), comp(other.comp), incremental(other.incremental) {
+        other.root = other.nil;
+    }
+    
+    AugmentedRBTree& operator=(AugmentedRBTree&& other) noexcept {
+        std::swap(pool, other.pool);
+        std::swap(root, other.root);
+        std::swap(nil, other.nil);
+        std::swap(monoid, other.monoid);
+        std::swap(comp, other.comp);
+        std::swap(incremental, other.incremental);
+        return *this;
+    }
+    
+    ~AugmentedRBTree() {
+        if (pool.use_count() > 1) {
+            // Other trees still use the blocks and the sentinel
+            destroyNodes(root);
+        } else if (!std::is_trivially_destructible<Node>::value) {
+            destroyNodes(root);
+            pool->destroy(nil);
+        }
+        // Otherwise the pool frees whole blocks when it goes away
+    }
+    
+    void clear() {
+        if (pool.use_count() > 1) {
+            destroyNodes(root);
+            root = nil;
+            return;
+        }
+        if (!std::is_trivially_destructible<Node>::value) {
+            destroyNodes(root);
+            pool->destroy(nil);
+        }
+        pool.reset();
+        initSentinel();
+    }
+    
+    // Replace the contents with a sorted range in O(n): no descents and
+    // no fixup rotations, sizes and summaries are filled in while linking.
+    // Elements are keys, or (key, value) pairs for a tree with values;
+    // through std::move_iterator they are moved into the nodes.
+    template<typename InputIt>
+    void buildFromSorted(InputIt first, InputIt last) {
+        clear();
+        std::vector<Node*> nodes;
+        for (; first != last; ++first) {
+            nodes.push_back(createFrom(*first));
+        }
+        linkAll(nodes);
+    }
+    
+    // Insert a batch of elements. Large batches are sorted, merged with the
+    // existing nodes in one pass and relinked, so each size and summary is
+    // recomputed once rather than once per inserted element.
+    template<typename InputIt>
+    void insertBatch(InputIt first, InputIt last) {
+        std::vector<Element> batch(first, last);
+        if (!preferRebuild(size(), batch.size())) {
+            for (Element& e : batch) {
+                insertNode(createFrom(std::move(e)));
+            }
+            return;
+        }
+        
+        if constexpr (std::is_arithmetic<Element>::value) {
+            std::sort(batch.begin(), batch.end(), comp);
+        } else {
+            // Elements with equal keys keep their batch order
+            std::stable_sort(batch.begin(), batch.end(), [this](const Element& a, const Element& b) {
+                return comp(keyOf(a), keyOf(b));
+            });
+        }
+        std::vector<Node*> existing;
+        existing.reserve(size());
+        collectInOrder(root, existing);
+        
+        std::vector<Node*> merged;
+        merged.reserve(existing.size() + batch.size());
+        std::size_t i = 0;
+        for (Element& e : batch) {
+            // Equal keys go after existing ones, as insert() places them
+            while (i < existing.size() && !comp(keyOf(e), existing[i]->key)) {
+                merged.push_back(existing[i++]);
+            }
+            merged.push_back(createFrom(std::move(e)));
+        }
+        while (i < existing.size()) {
+            merged.push_back(existing[i++]);
+        }
+        linkAll(merged);
+    }
+    
+    // Remove one occurrence of each key in the batch (missing keys are
+    // ignored). Large batches are matched against the tree in one sorted
+    // sweep and the survivors relinked.
+    template<typename InputIt>
+    void removeBatch(InputIt first, InputIt last) {
+        std::vector<Key> keys(first, last);
+        if (!preferRebuild(size(), keys.size())) {
+            for (const Key& key : keys) {
+                remove(key);
+            }
+            return;
+        }
+        
+        std::sort(keys.begin(), keys.end(), comp);
+        std::vector<Node*> nodes;
+        nodes.reserve(size());
+        collectInOrder(root, nodes);
+        
+        std::vector<Node*> kept;
+        kept.reserve(nodes.size());
+        std::size_t j = 0;
+        for (Node* x : nodes) {
+            while (j < keys.size() && comp(keys[j], x->key)) {
+                j++;
+            }
+            if (j < keys.size() && !comp(x->key, keys[j])) {
+                destroyNode(x);
+                j++;
+            } else {
+                kept.push_back(x);
+            }
+        }
+        linkAll(kept);
+    }
+    
+    // insert(key) for a key-only tree, insert(key, value) otherwise.
+    // An rvalue key (and value) is moved into the node.
+    template<typename... V>
+    void insert(const Key& key, V&&... value) {
+        static_assert(sizeof...(V) == (hasValue ? 1 : 0),
+                      "insert takes a value exactly when the tree stores one");
+        TREE_STATS_SCOPE(TREE_OP_INSERT);
+        insertNode(createNode(key, std::forward<V>(value)...));
+    }
+    
+    template<typename... V>
+    void insert(Key&& key, V&&... value) {
+        static_assert(sizeof...(V) == (hasValue ? 1 : 0),
+                      "insert takes a value exactly when the tree stores one");
+        TREE_STATS_SCOPE(TREE_OP_INSERT);
+        insertNode(createNode(std::move(key), std::forward<V>(value)...));
+    }
+    
+    // Construct the key in place from args, with no temporary; for a tree
+    // with values, the first argument builds the key and the rest the value
+    template<typename... Args>
+    void emplace(Args&&... args) {
+        TREE_STATS_SCOPE(TREE_OP_INSERT);
+        insertNode(createNode(std::forward<Args>(args)...));
+    }
+    
+    // Remove one element equivalent to key, if present
+    void remove(const Key& key) {
+        removeImpl(key);
+    }
+    
+    template<typename K, IfTransparent<K> = 0>
+    void remove(const K& key) {
+        removeImpl(key);
+    }
+    
+    // Keep keys < key here and return a tree holding keys >= key.
+    // O(log n); both trees share this tree's node pool afterwards.
+    AugmentedRBTree splitByKey(const Key& key) {
+        Node* l;
+        Node* r;
+        int hl, hr;
+        root->parent = nil;
+        splitNodes(root, blackHeight(root), key, l, hl, r, hr);
+        root = l;
+        root->parent = nil;
+        return AugmentedRBTree(pool, nil, r, monoid, comp, incremental);
+    }
+    
+    // Keep the k smallest elements here and return a tree with the rest
+    AugmentedRBTree splitByRank(SizeT k) {
+        Node* l;
+        Node* r;
+        int hl, hr;
+        root->parent = nil;
+        splitNodesByRank(root, blackHeight(root), k, l, hl, r, hr);
+        root = l;
+        root->parent = nil;
+        return AugmentedRBTree(pool, nil, r, monoid, comp, incremental);
+    }
+    
+    // Append every element of other, which must be >= every element here;
+    // other is left empty. O(log n) when both trees share a pool (e.g. one
+    // was split off the other); otherwise other's elements are first copied
+    // into this pool in O(m).
+    void join(AugmentedRBTree& other) {
+        if (other.empty()) return;
+        if (!empty() && comp(other.minimum(other.root)->key, maximum(root)->key)) {
+            throw std::invalid_argument("join: keys of other must not precede this tree");
+        }
+        
+        Node* r;
+        if (other.pool == pool) {
+            r = other.root;
+            other.root = other.nil;
+        } else {
+            std::vector<Node*> theirs, ours;
+            other.collectInOrder(other.root, theirs);
+            for (Node* x : theirs) {
+                ours.push_back(copyNode(x));
+            }
+            other.clear();
+            Node* saved = root;
+            linkAll(ours);
+            r = root;
+            root = saved;
+        }
+        
+        // Use the smallest element of the right part as the pivot
+        Node* pivot = minimum(r);
+        std::swap(root, r);
+        unlinkNode(pivot);
+        std::swap(root, r);
+        
+        int h;
+        root->parent = r->parent = nil;
+        root = joinNodes(root, blackHeight(root), pivot, r, blackHeight(r), h);
+        root->parent = nil;
+    }
+    
+    // Find k-th smallest element (1-indexed). The reference stays valid
+    // until that element is removed.
+    const Key& select(SizeT k) {
+        TREE_STATS_SCOPE(TREE_OP_SELECT);
+        Node* node = selectNode(root, k);
+        if (node == nil) {
+            throw std::out_of_range("Index out of range");
+        }
+        return node->key;
+    }
+    
+    // Find rank (position) of element (1-indexed), -1 if absent.
+    // Left subtree sizes are summed during the search descent itself.
+    SizeT rank(const Key& key) {
+        return rankImpl(key);
+    }
+    
+    template<typename K, IfTransparent<K> = 0>
+    SizeT rank(const K& key) {
+        return rankImpl(key);
+    }
+    
+    // Position key would take if inserted before any equal keys, i.e.
+    // 1 + number of elements < key (lower_bound). Works for absent keys.
+    SizeT rankOf(const Key& key) {
+        return rankOfImpl(key);
+    }
+    
+    template<typename K, IfTransparent<K> = 0>
+    SizeT rankOf(const K& key) {
+        return rankOfImpl(key);
+    }
+    
+    bool contains(const Key& key) {
+        return search(root, key) != nil;
+    }
+    
+    template<typename K, IfTransparent<K> = 0>
+    bool contains(const K& key) {
+        return search(root, key) != nil;
+    }
+    
+    // In-order iteration: begin() is O(log n), a full pass O(n)
+    const_iterator begin() {
+        return const_iterator(this, firstNode(root));
+    }
+    
+    const_iterator end() {
+        return const_iterator(this, nil);
+    }
+    
+    // First element not less than key (end() if none), in O(log n)
+    const_iterator lower_bound(const Key& key) {
+        return const_iterator(this, lowerBoundNode(key));
+    }
+    
+    template<typename K, IfTransparent<K> = 0>
+    const_iterator lower_bound(const K& key) {
+        return const_iterator(this, lowerBoundNode(key));
+    }
+    
+    // Elements of rank k1 .. k2 - 1 (1-indexed), i.e. k2 - k1 of them, in
+    // O(log n + (k2 - k1)): one descent to rank k1, then in-order steps
+    std::vector<Key> selectRange(SizeT k1, SizeT k2) {
+        if (k1 < 1 || k2 < k1 || k2 > size() + 1) {
+            throw std::out_of_range("Index out of range");
+        }
+        std::vector<Key> out;
+        out.reserve(static_cast<std::size_t>(k2 - k1));
+        if (k1 == k2) return out;
+        TREE_STATS_SCOPE(TREE_OP_SELECT);
+        Node* x = selectNode(root, k1);
+        for (SizeT k = k1; k < k2; k++) {
+            out.push_back(x->key);
+            x = nextNode(x);
+        }
+        return out;
+    }
+    
+    // select(k) for every k in ranks, in the same order. The descents run
+    // interleaved (BATCH_LANES at a time), so their cache misses overlap
+    // and a 100-bucket histogram costs far less than 100 selects.
+    std::vector<Key> selectMany(const std::vector<SizeT>& ranks) {
+        for (SizeT k : ranks) {
+            if (k < 1 || k > size()) {
+                throw std::out_of_range("Index out of range");
+            }
+        }
+        TREE_STATS_SCOPE(TREE_OP_SELECT);
+        std::vector<Key> out;
+        out.reserve(ranks.size());
+        Node* found[BATCH_LANES];
+        for (std::size_t i = 0; i < ranks.size(); i += BATCH_LANES) {
+            int lanes = static_cast<int>(std::min<std::size_t>(BATCH_LANES, ranks.size() - i));
+            selectLanes(ranks.data() + i, lanes, found);
+            for (int j = 0; j < lanes; j++) {
+                out.push_back(found[j]->key);
+            }
+        }
+        return out;
+    }
+    
+    // rank(key) for every key, in the same order, as interleaved descents
+    std::vector<SizeT> rankMany(const std::vector<Key>& keys) {
+        return rankManyImpl(keys, true);
+    }
+    
+    // rankOf(key) for every key, in the same order, as interleaved descents
+    std::vector<SizeT> rankOfMany(const std::vector<Key>& keys) {
+        return rankManyImpl(keys, false);
+    }
+    
+    // Summary of every element (the identity if empty), in O(1)
+    Summary summary() {
+        return root->summary;
+    }
+    
+    // Summary of the elements with keys in [lo, hi), in O(log n)
+    Summary fold(const Key& lo, const Key& hi) {
+        TREE_STATS_SCOPE(TREE_OP_QUERY);
+        Node* x = root;
+        while (x != nil) {
+            TREE_STATS_COUNT(nodesVisited);
+            push(x);
+            if (comp(x->key, lo)) {
+                x = x->right;
+            } else if (!comp(x->key, hi)) {
+                x = x->left;
+            } else {
+                // x splits the range: suffix of left, x, prefix of right
+                return Monoid::combine(Monoid::combine(suffixFrom(x->left, lo), singleOf(x)),
+                                       prefixBefore(x->right, hi));
+            }
+        }
+        return Monoid::identity();
+    }
+    
+    // Call fn(key), or fn(key, value), for every element in order, in O(n)
+    template<typename Fn>
+    void forEach(Fn fn) {
+        std::vector<Node*> stack;
+        Node* x = root;
+        while (x != nil || !stack.empty()) {
+            while (x != nil) {
+                push(x);
+                stack.push_back(x);
+                x = x->left;
+            }
+            x = stack.back();
+            stack.pop_back();
+            if constexpr (hasValue) {
+                fn(static_cast<const Key&>(x->key), static_cast<const Value&>(x->value));
+            } else {
+                fn(static_cast<const Key&>(x->key));
+            }
+            x = x->right;
+        }
+    }
+    
+    SizeT size() {
+        return root->size;
+    }
+    
+    bool empty() {
+        return root == nil;
+    }
+
+#ifdef TREE_STATS
+    const TreeStats& stats() const {
+        return treeStats;
+    }
+    
+    void resetStats() {
+        treeStats.reset();
+    }
+#endif
+};
+
+#endif // AUGMENTED_RBTREE_H
@@ -0,0 +1,1490 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <numeric>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include "bench.h"
+#include "ost.h"
+#include "pom.h"
+#include "josephus.h"
+#include "ost_compact.h"
+#include "ost_btree.h"
+#include "pom_blocked.h"
+#include "pom_persistent.h"
+#include "workload.h"
+#include "ost_concurrent.h"
+#include "snapshot.h"
+#include "ost_frozen.h"
+
+using namespace std;
+
+/**
+ * Benchmark driver (make bench)
+ * Re-runs the timing experiments of main.cpp through the bench.h
+ * harness and writes the same CSVs to results/. Every time column keeps
+ * its name and unit (microseconds) and now holds the median over the
+ * trials, followed by <column>_ci_low, <column>_ci_high, <column>_p95
+ * and <column>_p99.
+ *
+ * Usage: ./benchmark [trials] [warmup]
+ */
+
+static bench::Config config;
+
+// "<name>,<name>_ci_low,<name>_ci_high,<name>_p95,<name>_p99"
+string statColumns(const string& name) {
+    return name + "," + name + "_ci_low," + name + "_ci_high," +
+           name + "_p95," + name + "_p99";
+}
+
+void writeStat(ostream& out, const bench::Stats& s) {
+    out << s.median << "," << s.ciLow << "," << s.ciHigh << ","
+        << s.p95 << "," << s.p99;
+}
+
+// Time a whole phase per trial, reported in microseconds
+template<typename Body>
+bench::Stats phaseMicros(Body body) {
+    return bench::run(config, 1, body).scaled(1e-3);
+}
+
+// Time `ops` operations per trial, reported in microseconds per operation
+template<typename Body>
+bench::Stats perOpMicros(double ops, Body body) {
+    return bench::run(config, ops, body).scaled(1e-3);
+}
+
+void printStat(const bench::Stats& s, int width) {
+    cout << setw(width) << fixed << setprecision(3) << s.median;
+}
+
+void benchOSTPerformance() {
+    cout << "ost_performance.csv\n";
+    ofstream outfile("results/ost_performance.csv");
+    outfile << "n," << statColumns("insert_time") << "," << statColumns("build_time") << ","
+            << statColumns("select_time") << "," << statColumns("delete_time") << "\n";
+    
+    vector<int> sizes = {100, 500, 1000, 5000, 10000, 50000, 100000};
+    
+    for (int n : sizes) {
+        vector<int> keys(n);
+        iota(keys.begin(), keys.end(), 0);
+        
+        bench::Stats insertTime = phaseMicros([&](bench::Timer& t) {
+            OrderStatisticTree<int> ost;
+            t.start();
+            for (int i = 0; i < n; i++) {
+                ost.insert(i);
+            }
+            t.stop();
+        });
+        
+        bench::Stats buildTime = phaseMicros([&](bench::Timer& t) {
+            t.start();
+            OrderStatisticTree<int> ost(keys.begin(), keys.end());
+            t.stop();
+            bench::doNotOptimize(ost.size());
+        });
+        
+        OrderStatisticTree<int> ost(keys.begin(), keys.end());
+        bench::Stats selectTime = phaseMicros([&](bench::Timer& t) {
+            t.start();
+            for (int i = 1; i <= n/2; i++) {
+                bench::doNotOptimize(ost.select(i));
+            }
+            t.stop();
+        });
+        
+        bench::Stats deleteTime = phaseMicros([&](bench::Timer& t) {
+            OrderStatisticTree<int> victim(keys.begin(), keys.end());
+            t.start();
+            for (int i = 0; i < n/2; i++) {
+                victim.remove(i);
+            }
+            t.stop();
+        });
+        
+        cout << setw(10) << n;
+        printStat(insertTime, 15);
+        printStat(buildTime, 15);
+        printStat(selectTime, 15);
+        printStat(deleteTime, 15);
+        cout << "\n";
+        
+        outfile << n << ",";
+        writeStat(outfile, insertTime);
+        outfile << ",";
+        writeStat(outfile, buildTime);
+        outfile << ",";
+        writeStat(outfile, selectTime);
+        outfile << ",";
+        writeStat(outfile, deleteTime);
+        outfile << "\n";
+    }
+}
+
+struct JosephusTimes {
+    bench::Stats ost, btree, fenwick, naive;
+};
+
+JosephusTimes timeJosephus(int n, int m) {
+    JosephusTimes times;
+    times.ost = phaseMicros([&](bench::Timer& t) {
+        t.start();
+        vector<int> order = JosephusPermutation::generateOST(n, m);
+        t.stop();
+        bench::doNotOptimize(order.data());
+    });
+    times.btree = phaseMicros([&](bench::Timer& t) {
+        t.start();
+        vector<int> order = JosephusPermutation::generateOST<BTreeOrderStatisticTree<int>>(n, m);
+        t.stop();
+        bench::doNotOptimize(order.data());
+    });
+    times.fenwick = phaseMicros([&](bench::Timer& t) {
+        t.start();
+        vector<int> order = JosephusPermutation::generateFenwick(n, m);
+        t.stop();
+        bench::doNotOptimize(order.data());
+    });
+    times.naive = phaseMicros([&](bench::Timer& t) {
+        t.start();
+        vector<int> order = JosephusPermutation::generateNaive(n, m);
+        t.stop();
+        bench::doNotOptimize(order.data());
+    });
+    return times;
+}
+
+void writeJosephus(ostream& out, const JosephusTimes& times) {
+    writeStat(out, times.ost);
+    out << ",";
+    writeStat(out, times.btree);
+    out << ",";
+    writeStat(out, times.fenwick);
+    out << ",";
+    writeStat(out, times.naive);
+    out << "," << times.naive.median / times.ost.median << "\n";
+}
+
+void printJosephus(const JosephusTimes& times) {
+    printStat(times.ost, 15);
+    printStat(times.btree, 15);
+    printStat(times.fenwick, 15);
+    printStat(times.naive, 15);
+    cout << setw(14) << setprecision(2) << times.naive.median / times.ost.median << "x\n";
+}
+
+void benchJosephusComparison() {
+    cout << "josephus_comparison.csv\n";
+    ofstream outfile("results/josephus_comparison.csv");
+    outfile << "n,m," << statColumns("ost_time") << "," << statColumns("btree_time") << ","
+            << statColumns("fenwick_time") << ","
+            << statColumns("naive_time") << ",speedup\n";
+    
+    vector<pair<int, int>> testCases = {
+        {100, 3}, {500, 3}, {1000, 3}, {5000, 3}, {10000, 3},
+        {100, 7}, {500, 7}, {1000, 7}, {5000, 7}, {10000, 7}
+    };
+    
+    for (const auto& [n, m] : testCases) {
+        JosephusTimes times = timeJosephus(n, m);
+        cout << setw(10) << n << setw(12) << m;
+        printJosephus(times);
+        outfile << n << "," << m << ",";
+        writeJosephus(outfile, times);
+    }
+}
+
+void benchJosephusParallel() {
+    int hardware = max(1, (int)thread::hardware_concurrency());
+    cout << "josephus_parallel.csv (" << hardware << " hardware threads)\n";
+    ofstream outfile("results/josephus_parallel.csv");
+    outfile << "n,m,threads," << statColumns("fenwick_time") << ","
+            << statColumns("parallel_time") << ",speedup\n";
+    
+    vector<int> threadCounts = {1, 2, 4};
+    if (hardware > 4) {
+        threadCounts.push_back(hardware);
+    }
+    
+    const int n = 1000000;
+    for (int m : {3, 100}) {
+        bench::Stats fenwickTime = phaseMicros([&](bench::Timer& t) {
+            t.start();
+            vector<int> order = JosephusPermutation::generateFenwick(n, m);
+            t.stop();
+            bench::doNotOptimize(order.data());
+        });
+        for (int threads : threadCounts) {
+            bench::Stats parallelTime = phaseMicros([&](bench::Timer& t) {
+                t.start();
+                vector<int> order = JosephusPermutation::generateParallel(n, m, threads);
+                t.stop();
+                bench::doNotOptimize(order.data());
+            });
+            cout << setw(10) << n << setw(8) << m << setw(6) << threads;
+            printStat(fenwickTime, 15);
+            printStat(parallelTime, 15);
+            cout << setw(14) << setprecision(2) << fenwickTime.median / parallelTime.median << "x\n";
+            outfile << n << "," << m << "," << threads << ",";
+            writeStat(outfile, fenwickTime);
+            outfile << ",";
+            writeStat(outfile, parallelTime);
+            outfile << "," << fenwickTime.median / parallelTime.median << "\n";
+        }
+    }
+}
+
+// generate() against the engines it chooses between, each run alone
+// (laps = generateParallel on one thread), plus this machine's cost model
+void benchJosephusAdaptive() {
+    JosephusCostModel model = JosephusPermutation::calibrate();
+    cout << "josephus_cost_model.csv (lap " << model.lapEntry << " + " << model.lapRemoval
+         << "/m, Fenwick " << model.fenwickLevel << "/level, erase " << model.shiftErase << " + "
+         << model.shiftEntry << "/entry ns; Fenwick from " << model.fenwickFrom() << ")\n";
+    ofstream modelfile("results/josephus_cost_model.csv");
+    modelfile << "lap_entry_ns,lap_removal_ns,fenwick_level_ns,shift_erase_ns,shift_entry_ns,fenwick_from\n"
+              << model.lapEntry << "," << model.lapRemoval << "," << model.fenwickLevel << ","
+              << model.shiftErase << "," << model.shiftEntry << "," << model.fenwickFrom() << "\n";
+    
+    cout << "josephus_adaptive.csv\n";
+    ofstream outfile("results/josephus_adaptive.csv");
+    outfile << "n,m," << statColumns("generate_time") << "," << statColumns("fenwick_time") << ","
+            << statColumns("laps_time") << ",best_fixed_ratio\n";
+    
+    for (int n : {10000, 100000, 1000000}) {
+        for (int m : {2, 7, 100, 1000, 100000}) {
+            auto timeRun = [&](auto run) {
+                return phaseMicros([&](bench::Timer& t) {
+                    t.start();
+                    vector<int> order = run();
+                    t.stop();
+                    bench::doNotOptimize(order.data());
+                });
+            };
+            bench::Stats generateTime = timeRun([&]() {
+                return JosephusPermutation::generate(n, m, model);
+            });
+            bench::Stats fenwickTime = timeRun([&]() {
+                return JosephusPermutation::generateFenwick(n, m);
+            });
+            bench::Stats lapsTime = timeRun([&]() {
+                return JosephusPermutation::generateParallel(n, m, 1);
+            });
+            // Below 1: generate beats the best single engine
+            double ratio = generateTime.median / min(fenwickTime.median, lapsTime.median);
+            
+            cout << setw(10) << n << setw(8) << m;
+            printStat(generateTime, 15);
+            printStat(fenwickTime, 15);
+            printStat(lapsTime, 15);
+            cout << setw(10) << setprecision(2) << ratio << "\n";
+            outfile << n << "," << m << ",";
+            writeStat(outfile, generateTime);
+            outfile << ",";
+            writeStat(outfile, fenwickTime);
+            outfile << ",";
+            writeStat(outfile, lapsTime);
+            outfile << "," << ratio << "\n";
+        }
+    }
+}
+
+// Run `threads` readers of readsPerThread reads each while one writer
+// keeps updating at a modest rate; only the readers' span is timed
+template<typename Read, typename Write>
+void timeReaders(bench::Timer& t, int threads, int readsPerThread, Read read, Write write) {
+    atomic<bool> done(false);
+    thread writer([&]() {
+        for (int i = 0; !done.load(memory_order_relaxed); i++) {
+            write(i);
+            this_thread::sleep_for(chrono::microseconds(50));
+        }
+    });
+    
+    vector<long long> sums(threads);
+    vector<thread> readers;
+    t.start();
+    for (int r = 0; r < threads; r++) {
+        readers.emplace_back([&, r]() {
+            unsigned x = 2463534242u + r;
+            long long sum = 0;
+            for (int i = 0; i < readsPerThread; i++) {
+                x ^= x << 13;
+                x ^= x >> 17;
+                x ^= x << 5;
+                sum += read(r, x, i & 1);
+            }
+            sums[r] = sum;
+        });
+    }
+    for (thread& reader : readers) {
+        reader.join();
+    }
+    t.stop();
+    
+    done = true;
+    writer.join();
+    bench::doNotOptimize(sums.data());
+}
+
+void benchConcurrentReads() {
+    int hardware = max(1, (int)thread::hardware_concurrency());
+    cout << "concurrent_reads.csv (" << hardware << " hardware threads)\n";
+    ofstream outfile("results/concurrent_reads.csv");
+    outfile << "threads," << statColumns("mutex_time") << "," << statColumns("snapshot_time")
+            << ",mutex_mops,snapshot_mops\n";
+    
+    const int n = 1000000;
+    const int readsPerThread = 50000;
+    vector<int> keys(n);
+    for (int i = 0; i < n; i++) {
+        keys[i] = 2 * i;
+    }
+    
+    // Baseline: one tree behind one lock, as a service would wrap it
+    OrderStatisticTree<int> locked(keys.begin(), keys.end());
+    mutex lock;
+    ConcurrentOrderStatisticTree<int> concurrent(keys.begin(), keys.end(), 4096);
+    
+    // The writer toggles odd keys, so sizes stay within one of n
+    auto mutexWrite = [&](int i) {
+        lock_guard<mutex> guard(lock);
+        if (i & 1) locked.remove(2 * (i / 2) + 1);
+        else locked.insert(2 * (i / 2) + 1);
+    };
+    auto snapshotWrite = [&](int i) {
+        if (i & 1) concurrent.remove(2 * (i / 2) + 1);
+        else concurrent.insert(2 * (i / 2) + 1);
+    };
+    
+    for (int threads : {1, 2, 4, 8}) {
+        double ops = (double)threads * readsPerThread;
+        bench::Stats mutexTime = perOpMicros(ops, [&](bench::Timer& t) {
+            timeReaders(t, threads, readsPerThread, [&](int, unsigned x, bool selectOp) -> long long {
+                lock_guard<mutex> guard(lock);
+                return selectOp ? locked.select(1 + (int)(x % (unsigned)n))
+                                : locked.rankOf((int)(x % (2u * n)));
+            }, mutexWrite);
+        });
+        
+        vector<ConcurrentOrderStatisticTree<int>::Reader> readers;
+        for (int r = 0; r < threads; r++) {
+            readers.push_back(concurrent.reader());
+        }
+        bench::Stats snapshotTime = perOpMicros(ops, [&](bench::Timer& t) {
+            timeReaders(t, threads, readsPerThread, [&](int r, unsigned x, bool selectOp) -> long long {
+                return selectOp ? readers[r].select(1 + (int)(x % (unsigned)n))
+                                : readers[r].rankOf((int)(x % (2u * n)));
+            }, snapshotWrite);
+        });
+        
+        // Aggregate reads per microsecond = millions of reads per second
+        double mutexMops = 1.0 / mutexTime.median;
+        double snapshotMops = 1.0 / snapshotTime.median;
+        cout << setw(10) << threads;
+        printStat(mutexTime, 15);
+        printStat(snapshotTime, 15);
+        cout << setw(12) << setprecision(2) << mutexMops << setw(12) << snapshotMops << " Mops/s\n";
+        outfile << threads << ",";
+        writeStat(outfile, mutexTime);
+        outfile << ",";
+        writeStat(outfile, snapshotTime);
+        outfile << "," << mutexMops << "," << snapshotMops << "\n";
+    }
+}
+
+void benchBlockedPOM() {
+    cout << "pom_blocked.csv (SIMD level " << simd::levelName(simd::level()) << ")\n";
+    ofstream outfile("results/pom_blocked.csv");
+    outfile << "intervals," << statColumns("rb_insert_time") << "," << statColumns("blocked_insert_time") << ","
+            << statColumns("blocked_scalar_insert_time") << "," << statColumns("rb_delete_time") << ","
+            << statColumns("blocked_delete_time") << "," << statColumns("blocked_scalar_delete_time") << "\n";
+    
+    vector<int> sizes = {1000, 10000, 100000};
+    simd::SimdLevel best = simd::level();
+    
+    for (int n : sizes) {
+        vector<Interval> workload;
+        for (int i = 0; i < n; i++) {
+            int start = (int)(((long long)i * 7919) % n) * 10;
+            workload.push_back(Interval(start, start + 10, ((i * 17) % 20) - 10));
+        }
+        
+        bench::Stats rbInsert = phaseMicros([&](bench::Timer& t) {
+            POMTree pom;
+            t.start();
+            for (const auto& iv : workload) {
+                pom.insert(iv);
+            }
+            t.stop();
+        });
+        bench::Stats rbDelete = phaseMicros([&](bench::Timer& t) {
+            POMTree pom;
+            pom.insertBatch(workload.begin(), workload.end());
+            t.start();
+            for (const auto& iv : workload) {
+                pom.remove(iv);
+            }
+            t.stop();
+        });
+        
+        // Blocked tree with the best kernels, then with the scalar ones
+        bench::Stats blockedInsert[2], blockedDelete[2];
+        simd::SimdLevel levels[2] = {best, simd::SIMD_SCALAR};
+        for (int l = 0; l < 2; l++) {
+            simd::setLevel(levels[l]);
+            blockedInsert[l] = phaseMicros([&](bench::Timer& t) {
+                BlockedPOMTree<> pom;
+                t.start();
+                for (const auto& iv : workload) {
+                    pom.insert(iv);
+                }
+                t.stop();
+            });
+            blockedDelete[l] = phaseMicros([&](bench::Timer& t) {
+                BlockedPOMTree<> pom;
+                for (const auto& iv : workload) {
+                    pom.insert(iv);
+                }
+                t.start();
+                for (const auto& iv : workload) {
+                    pom.remove(iv);
+                }
+                t.stop();
+            });
+        }
+        simd::setLevel(best);
+        
+        cout << setw(12) << n;
+        printStat(rbInsert, 15);
+        printStat(blockedInsert[0], 15);
+        printStat(blockedInsert[1], 15);
+        printStat(rbDelete, 15);
+        printStat(blockedDelete[0], 15);
+        printStat(blockedDelete[1], 15);
+        cout << "\n";
+        
+        outfile << n << ",";
+        writeStat(outfile, rbInsert);
+        outfile << ",";
+        writeStat(outfile, blockedInsert[0]);
+        outfile << ",";
+        writeStat(outfile, blockedInsert[1]);
+        outfile << ",";
+        writeStat(outfile, rbDelete);
+        outfile << ",";
+        writeStat(outfile, blockedDelete[0]);
+        outfile << ",";
+        writeStat(outfile, blockedDelete[1]);
+        outfile << "\n";
+    }
+}
+
+void benchAblationM() {
+    cout << "ablation_m.csv\n";
+    ofstream outfile("results/ablation_m.csv");
+    outfile << "m," << statColumns("ost_time") << "," << statColumns("btree_time") << ","
+            << statColumns("fenwick_time") << ","
+            << statColumns("naive_time") << ",speedup\n";
+    
+    int n = 10000;
+    vector<int> mValues = {2, 3, 5, 10, 20, 50, 100};
+    
+    for (int m : mValues) {
+        JosephusTimes times = timeJosephus(n, m);
+        cout << setw(10) << m;
+        printJosephus(times);
+        outfile << m << ",";
+        writeJosephus(outfile, times);
+    }
+}
+
+void benchPOMPerformance() {
+    cout << "pom_performance.csv\n";
+    ofstream outfile("results/pom_performance.csv");
+    outfile << "intervals," << statColumns("insert_time") << "," << statColumns("findpom_time") << ","
+            << statColumns("delete_time") << "\n";
+    
+    vector<int> sizes = {100, 500, 1000, 5000, 10000};
+    const int queries = 10000;
+    
+    for (int n : sizes) {
+        vector<Interval> workload;
+        for (int i = 0; i < n; i++) {
+            workload.push_back(Interval(i * 10, (i + 1) * 10, (i % 2 == 0 ? 5 : -3)));
+        }
+        
+        bench::Stats insertTime = phaseMicros([&](bench::Timer& t) {
+            POMTree pom;
+            t.start();
+            for (const auto& iv : workload) {
+                pom.insert(iv);
+            }
+            t.stop();
+        });
+        
+        POMTree pom;
+        pom.insertBatch(workload.begin(), workload.end());
+        bench::Stats findTime = perOpMicros(queries, [&](bench::Timer& t) {
+            t.start();
+            for (int i = 0; i < queries; i++) {
+                bench::doNotOptimize(pom.findPOM());
+            }
+            t.stop();
+        });
+        
+        bench::Stats deleteTime = phaseMicros([&](bench::Timer& t) {
+            POMTree victim;
+            victim.insertBatch(workload.begin(), workload.end());
+            t.start();
+            for (int i = 0; i < n/2; i++) {
+                victim.remove(workload[i]);
+            }
+            t.stop();
+        });
+        
+        cout << setw(12) << n;
+        printStat(insertTime, 15);
+        cout << setw(15) << setprecision(5) << findTime.median;
+        printStat(deleteTime, 15);
+        cout << "\n";
+        
+        outfile << n << ",";
+        writeStat(outfile, insertTime);
+        outfile << ",";
+        writeStat(outfile, findTime);
+        outfile << ",";
+        writeStat(outfile, deleteTime);
+        outfile << "\n";
+    }
+}
+
+void benchPOMUpdateModes() {
+    cout << "pom_update_modes.csv\n";
+    ofstream outfile("results/pom_update_modes.csv");
+    outfile << "intervals," << statColumns("full_insert_time") << "," << statColumns("incremental_insert_time") << ","
+            << statColumns("full_delete_time") << "," << statColumns("incremental_delete_time") << "\n";
+    
+    vector<int> sizes = {100, 500, 1000, 5000, 10000};
+    POMUpdateMode modes[2] = {POM_FULL_PATH, POM_INCREMENTAL};
+    
+    for (int n : sizes) {
+        vector<Interval> workload;
+        for (int i = 0; i < n; i++) {
+            int start = (int)(((long long)i * 7919) % n) * 10;
+            workload.push_back(Interval(start, start + 10, ((i * 17) % 20) - 10));
+        }
+        
+        bench::Stats insertTimes[2], deleteTimes[2];
+        for (int k = 0; k < 2; k++) {
+            insertTimes[k] = phaseMicros([&](bench::Timer& t) {
+                POMTree pom(modes[k]);
+                t.start();
+                for (const auto& iv : workload) {
+                    pom.insert(iv);
+                }
+                t.stop();
+            });
+            deleteTimes[k] = phaseMicros([&](bench::Timer& t) {
+                POMTree pom(modes[k]);
+                pom.insertBatch(workload.begin(), workload.end());
+                t.start();
+                for (const auto& iv : workload) {
+                    pom.remove(iv);
+                }
+                t.stop();
+            });
+        }
+        
+        cout << setw(12) << n;
+        printStat(insertTimes[0], 18);
+        printStat(insertTimes[1], 18);
+        printStat(deleteTimes[0], 18);
+        printStat(deleteTimes[1], 18);
+        cout << "\n";
+        
+        outfile << n << ",";
+        writeStat(outfile, insertTimes[0]);
+        outfile << ",";
+        writeStat(outfile, insertTimes[1]);
+        outfile << ",";
+        writeStat(outfile, deleteTimes[0]);
+        outfile << ",";
+        writeStat(outfile, deleteTimes[1]);
+        outfile << "\n";
+    }
+}
+
+void benchPOMRemoveLookup() {
+    cout << "pom_remove.csv\n";
+    ofstream outfile("results/pom_remove.csv");
+    outfile << "intervals," << statColumns("search_remove_time") << ","
+            << statColumns("indexed_remove_time") << "," << statColumns("handle_erase_time") << "\n";
+    
+    vector<int> sizes = {1000, 10000, 100000};
+    
+    for (int n : sizes) {
+        // Eight intervals share every start, with distinct ends
+        vector<Interval> workload;
+        for (int i = 0; i < n; i++) {
+            int start = (int)(((long long)i * 7919) % (n / 8)) * 10;
+            workload.push_back(Interval(start, start + 1 + i, ((i * 17) % 20) - 10));
+        }
+        
+        bench::Stats searchTime = perOpMicros(n, [&](bench::Timer& t) {
+            POMTree pom;
+            pom.insertBatch(workload.begin(), workload.end());
+            t.start();
+            for (const auto& iv : workload) {
+                pom.remove(iv);
+            }
+            t.stop();
+        });
+        bench::Stats indexedTime = perOpMicros(n, [&](bench::Timer& t) {
+            POMTree pom;
+            pom.enableIndex();
+            pom.insertBatch(workload.begin(), workload.end());
+            t.start();
+            for (const auto& iv : workload) {
+                pom.remove(iv);
+            }
+            t.stop();
+        });
+        bench::Stats handleTime = perOpMicros(n, [&](bench::Timer& t) {
+            POMTree pom;
+            vector<POMHandle> handles;
+            handles.reserve(n);
+            for (const auto& iv : workload) {
+                handles.push_back(pom.insert(iv));
+            }
+            t.start();
+            for (POMHandle h : handles) {
+                pom.erase(h);
+            }
+            t.stop();
+        });
+        
+        cout << setw(12) << n;
+        printStat(searchTime, 15);
+        printStat(indexedTime, 15);
+        printStat(handleTime, 15);
+        cout << "\n";
+        
+        outfile << n << ",";
+        writeStat(outfile, searchTime);
+        outfile << ",";
+        writeStat(outfile, indexedTime);
+        outfile << ",";
+        writeStat(outfile, handleTime);
+        outfile << "\n";
+    }
+}
+
+void benchPOMRangeAdd() {
+    cout << "pom_range_add.csv\n";
+    ofstream outfile("results/pom_range_add.csv");
+    outfile << "intervals,span," << statColumns("range_add_time") << ","
+            << statColumns("reinsert_time") << "\n";
+    
+    vector<int> sizes = {10000, 100000, 1000000};
+    
+    for (int n : sizes) {
+        // Interval i starts at 10 * i, inserted in scrambled order
+        vector<Interval> workload;
+        for (int i = 0; i < n; i++) {
+            int index = (int)(((long long)i * 7919) % n);
+            workload.push_back(Interval(index * 10, index * 10 + 10, ((i * 17) % 20) - 10));
+        }
+        
+        for (int span : {100, n / 10}) {
+            // Each call shifts `span` consecutive intervals (times per call)
+            int calls = max(4, min(1000, 200000 / span));
+            vector<int> offsets, deltas;
+            for (int q = 0; q < calls; q++) {
+                offsets.push_back((int)(((long long)q * 104729) % (n - span + 1)));
+                deltas.push_back(q % 2 ? -(1 + q % 5) : 1 + q % 5);
+            }
+            
+            bench::Stats rangeTime = perOpMicros(calls, [&](bench::Timer& t) {
+                POMTree pom;
+                pom.insertBatch(workload.begin(), workload.end());
+                // The first call sets up the melt limits in O(n); keep it untimed
+                pom.addRange(0, 10, 1);
+                pom.addRange(0, 10, -1);
+                t.start();
+                for (int q = 0; q < calls; q++) {
+                    pom.addRange(offsets[q] * 10, (offsets[q] + span) * 10, deltas[q]);
+                }
+                t.stop();
+                bench::doNotOptimize(pom.findPOM().maxpref);
+            });
+            bench::Stats reinsertTime = perOpMicros(calls, [&](bench::Timer& t) {
+                POMTree pom;
+                pom.insertBatch(workload.begin(), workload.end());
+                vector<int> values(n);
+                for (const auto& iv : workload) {
+                    values[iv.start / 10] = iv.value;
+                }
+                t.start();
+                for (int q = 0; q < calls; q++) {
+                    for (int i = offsets[q]; i < offsets[q] + span; i++) {
+                        pom.remove(Interval(i * 10, i * 10 + 10, values[i]));
+                        values[i] += deltas[q];
+                        pom.insert(Interval(i * 10, i * 10 + 10, values[i]));
+                    }
+                }
+                t.stop();
+                bench::doNotOptimize(pom.findPOM().maxpref);
+            });
+            
+            cout << setw(12) << n << setw(10) << span;
+            printStat(rangeTime, 15);
+            printStat(reinsertTime, 15);
+            cout << "\n";
+            
+            outfile << n << "," << span << ",";
+            writeStat(outfile, rangeTime);
+            outfile << ",";
+            writeStat(outfile, reinsertTime);
+            outfile << "\n";
+        }
+    }
+}
+
+void benchPOMSubarray() {
+    cout << "pom_subarray.csv\n";
+    ofstream outfile("results/pom_subarray.csv");
+    outfile << "intervals," << statColumns("pom_insert_time") << ","
+            << statColumns("subarray_insert_time") << "," << statColumns("scan_time") << "\n";
+    
+    vector<int> sizes = {1000, 10000, 100000};
+    
+    for (int n : sizes) {
+        vector<Interval> workload;
+        for (int i = 0; i < n; i++) {
+            int index = (int)(((long long)i * 7919) % n);
+            workload.push_back(Interval(index * 10, index * 10 + 10, ((i * 17) % 20) - 10));
+        }
+        
+        bench::Stats pomTime = perOpMicros(n, [&](bench::Timer& t) {
+            POMTree pom;
+            t.start();
+            for (const auto& iv : workload) {
+                pom.insert(iv);
+            }
+            t.stop();
+            bench::doNotOptimize(pom.findPOM().maxpref);
+        });
+        bench::Stats subarrayTime = perOpMicros(n, [&](bench::Timer& t) {
+            POMSubarrayTree pom;
+            t.start();
+            for (const auto& iv : workload) {
+                pom.insert(iv);
+            }
+            t.stop();
+            bench::doNotOptimize(pom.findPOM().maxsub);
+        });
+        // What the augmentation replaces: one O(n) max-subarray scan
+        POMTree scanned;
+        scanned.insertBatch(workload.begin(), workload.end());
+        bench::Stats scanTime = perOpMicros(1, [&](bench::Timer& t) {
+            t.start();
+            long long best = LLONG_MIN, run = 0;
+            scanned.forEach([&](const Interval& iv) {
+                run = max(run + iv.value, (long long)iv.value);
+                best = max(best, run);
+            });
+            t.stop();
+            bench::doNotOptimize(best);
+        });
+        
+        cout << setw(12) << n;
+        printStat(pomTime, 15);
+        printStat(subarrayTime, 15);
+        printStat(scanTime, 15);
+        cout << "\n";
+        
+        outfile << n << ",";
+        writeStat(outfile, pomTime);
+        outfile << ",";
+        writeStat(outfile, subarrayTime);
+        outfile << ",";
+        writeStat(outfile, scanTime);
+        outfile << "\n";
+    }
+}
+
+// Full in-order scans, per element: a select(k) loop against iterators,
+// forEach and selectRange over the whole tree
+void benchOSTIteration() {
+    cout << "ost_iteration.csv\n";
+    ofstream outfile("results/ost_iteration.csv");
+    outfile << "elements," << statColumns("select_loop_time") << "," << statColumns("iterator_time")
+            << "," << statColumns("foreach_time") << "," << statColumns("select_range_time") << "\n";
+    
+    vector<int> sizes = {10000, 100000, 1000000};
+    
+    for (int n : sizes) {
+        // Random insertion order, so nodes are scattered across the slab
+        OrderStatisticTree<int> ost;
+        for (int i = 0; i < n; i++) {
+            ost.insert((int)(((long long)i * 7919) % n));
+        }
+        
+        bench::Stats selectTime = perOpMicros(n, [&](bench::Timer& t) {
+            long long sum = 0;
+            t.start();
+            for (int k = 1; k <= n; k++) {
+                sum += ost.select(k);
+            }
+            t.stop();
+            bench::doNotOptimize(sum);
+        });
+        bench::Stats iteratorTime = perOpMicros(n, [&](bench::Timer& t) {
+            long long sum = 0;
+            t.start();
+            for (int key : ost) {
+                sum += key;
+            }
+            t.stop();
+            bench::doNotOptimize(sum);
+        });
+        bench::Stats forEachTime = perOpMicros(n, [&](bench::Timer& t) {
+            long long sum = 0;
+            t.start();
+            ost.forEach([&](int key) { sum += key; });
+            t.stop();
+            bench::doNotOptimize(sum);
+        });
+        bench::Stats rangeTime = perOpMicros(n, [&](bench::Timer& t) {
+            t.start();
+            vector<int> keys = ost.selectRange(1, n + 1);
+            t.stop();
+            bench::doNotOptimize(keys.back());
+        });
+        
+        cout << setw(12) << n;
+        printStat(selectTime, 15);
+        printStat(iteratorTime, 15);
+        printStat(forEachTime, 15);
+        printStat(rangeTime, 15);
+        cout << "\n";
+        
+        outfile << n << ",";
+        writeStat(outfile, selectTime);
+        outfile << ",";
+        writeStat(outfile, iteratorTime);
+        outfile << ",";
+        writeStat(outfile, forEachTime);
+        outfile << ",";
+        writeStat(outfile, rangeTime);
+        outfile << "\n";
+    }
+}
+
+// Percentile batches, per batch: one select(k) per rank against
+// selectMany, and rankOf per key against rankOfMany. As in a monitor that
+// polls every second, the tree takes a burst of untimed updates before
+// each batch, so the batches do not replay a warm path.
+void benchOSTSelectMany() {
+    cout << "ost_select_many.csv\n";
+    ofstream outfile("results/ost_select_many.csv");
+    outfile << "elements," << statColumns("select_4_time") << "," << statColumns("select_many_4_time")
+            << "," << statColumns("select_100_time") << "," << statColumns("select_many_100_time")
+            << "," << statColumns("rank_of_100_time") << "," << statColumns("rank_of_many_100_time")
+            << "\n";
+    
+    vector<int> sizes = {10000, 100000, 1000000};
+    const int batches = 200;
+    const int burst = 256;
+    
+    for (int n : sizes) {
+        OrderStatisticTree<int> ost;
+        for (int i = 0; i < n; i++) {
+            ost.insert((int)(((long long)i * 7919) % n));
+        }
+        
+        // p50/p90/p99/p999, and a 100-bucket histogram
+        vector<int> quantiles = {n / 2, n * 9 / 10, n * 99 / 100, n * 999 / 1000};
+        vector<int> histogram, bounds;
+        for (int b = 1; b <= 100; b++) {
+            histogram.push_back(max(1, (int)((long long)n * b / 100)));
+            bounds.push_back((int)((long long)n * b / 100));
+        }
+        
+        // Insert a burst of keys and remove it again, leaving the size as is
+        unsigned long long seed = 1;
+        vector<int> added(burst);
+        auto churn = [&]() {
+            for (int& key : added) {
+                seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+                key = (int)((seed >> 33) % n);
+                ost.insert(key);
+            }
+            for (int key : added) {
+                ost.remove(key);
+            }
+        };
+        auto timeBatches = [&](auto query) {
+            return perOpMicros(batches, [&](bench::Timer& t) {
+                long long sum = 0;
+                for (int i = 0; i < batches; i++) {
+                    churn();
+                    t.start();
+                    sum += query();
+                    t.stop();
+                }
+                bench::doNotOptimize(sum);
+            });
+        };
+        auto selectEach = [&](const vector<int>& ranks) {
+            return [&]() {
+                long long sum = 0;
+                for (int k : ranks) {
+                    sum += ost.select(k);
+                }
+                return sum;
+            };
+        };
+        auto selectMany = [&](const vector<int>& ranks) {
+            return [&]() { return (long long)ost.selectMany(ranks).back(); };
+        };
+        bench::Stats select4 = timeBatches(selectEach(quantiles));
+        bench::Stats selectMany4 = timeBatches(selectMany(quantiles));
+        bench::Stats select100 = timeBatches(selectEach(histogram));
+        bench::Stats selectMany100 = timeBatches(selectMany(histogram));
+        bench::Stats rankOf100 = timeBatches([&]() {
+            long long sum = 0;
+            for (int key : bounds) {
+                sum += ost.rankOf(key);
+            }
+            return sum;
+        });
+        bench::Stats rankOfMany100 = timeBatches([&]() {
+            return (long long)ost.rankOfMany(bounds).back();
+        });
+        
+        cout << setw(12) << n;
+        printStat(select4, 15);
+        printStat(selectMany4, 15);
+        printStat(select100, 15);
+        printStat(selectMany100, 15);
+        printStat(rankOf100, 15);
+        printStat(rankOfMany100, 15);
+        cout << "\n";
+        
+        outfile << n << ",";
+        writeStat(outfile, select4);
+        outfile << ",";
+        writeStat(outfile, selectMany4);
+        outfile << ",";
+        writeStat(outfile, select100);
+        outfile << ",";
+        writeStat(outfile, selectMany100);
+        outfile << ",";
+        writeStat(outfile, rankOf100);
+        outfile << ",";
+        writeStat(outfile, rankOfMany100);
+        outfile << "\n";
+    }
+}
+
+void benchPersistentPOM() {
+    cout << "pom_persistent.csv\n";
+    ofstream outfile("results/pom_persistent.csv");
+    outfile << "intervals," << statColumns("pom_insert_time") << "," << statColumns("persistent_insert_time") << ","
+            << statColumns("pom_delete_time") << "," << statColumns("persistent_delete_time") << ","
+            << statColumns("history_query_time") << "\n";
+    
+    vector<int> sizes = {1000, 10000, 100000};
+    
+    for (int n : sizes) {
+        vector<Interval> workload;
+        for (int i = 0; i < n; i++) {
+            int start = (int)(((long long)i * 7919) % n) * 10;
+            workload.push_back(Interval(start, start + 10, ((i * 17) % 20) - 10));
+        }
+        
+        bench::Stats pomInsert = perOpMicros(n, [&](bench::Timer& t) {
+            POMTree pom;
+            t.start();
+            for (const auto& iv : workload) {
+                pom.insert(iv);
+            }
+            t.stop();
+        });
+        // Every intermediate version stays alive, as a history would keep it
+        vector<PersistentPOMTree> versions;
+        bench::Stats persistentInsert = perOpMicros(n, [&](bench::Timer& t) {
+            versions.assign(1, PersistentPOMTree());
+            versions.reserve(n + 1);
+            t.start();
+            for (const auto& iv : workload) {
+                versions.push_back(versions.back().insert(iv));
+            }
+            t.stop();
+        });
+        bench::Stats pomDelete = perOpMicros(n, [&](bench::Timer& t) {
+            POMTree pom;
+            pom.insertBatch(workload.begin(), workload.end());
+            t.start();
+            for (const auto& iv : workload) {
+                pom.remove(iv);
+            }
+            t.stop();
+        });
+        bench::Stats persistentDelete = perOpMicros(n, [&](bench::Timer& t) {
+            vector<PersistentPOMTree> history(1, versions.back());
+            history.reserve(n + 1);
+            t.start();
+            for (const auto& iv : workload) {
+                history.push_back(history.back().remove(iv));
+            }
+            t.stop();
+        });
+        
+        // findPOM over a window of an older version
+        const int queries = 10000;
+        bench::Stats historyQuery = perOpMicros(queries, [&](bench::Timer& t) {
+            long long sum = 0;
+            t.start();
+            for (int q = 0; q < queries; q++) {
+                const PersistentPOMTree& v = versions[((long long)q * 2654435761u) % versions.size()];
+                int a = (q * 37) % n * 10;
+                sum += v.findPOM(a, a + n).sum;
+            }
+            t.stop();
+            bench::doNotOptimize(sum);
+        });
+        
+        cout << setw(12) << n;
+        printStat(pomInsert, 15);
+        printStat(persistentInsert, 15);
+        printStat(pomDelete, 15);
+        printStat(persistentDelete, 15);
+        printStat(historyQuery, 15);
+        cout << "\n";
+        
+        outfile << n << ",";
+        writeStat(outfile, pomInsert);
+        outfile << ",";
+        writeStat(outfile, persistentInsert);
+        outfile << ",";
+        writeStat(outfile, pomDelete);
+        outfile << ",";
+        writeStat(outfile, persistentDelete);
+        outfile << ",";
+        writeStat(outfile, historyQuery);
+        outfile << "\n";
+    }
+}
+
+// Pointer-based vs B-tree vs frozen Eytzinger select/rank at sizes past L2
+void benchFrozenOST() {
+    cout << "ost_frozen.csv\n";
+    ofstream outfile("results/ost_frozen.csv");
+    outfile << "n," << statColumns("ost_select_time") << "," << statColumns("frozen_select_time") << ","
+            << statColumns("ost_rank_time") << "," << statColumns("btree_rank_time") << ","
+            << statColumns("frozen_rank_time") << "\n";
+    
+    vector<int> sizes = {10000, 100000, 1000000, 4000000};
+    const int queries = 100000;
+    
+    for (int n : sizes) {
+        vector<int> keys(n);
+        for (int i = 0; i < n; i++) {
+            keys[i] = 2 * i;  // Odd probes miss
+        }
+        OrderStatisticTree<int> ost(keys.begin(), keys.end());
+        BTreeOrderStatisticTree<int> btree(keys.begin(), keys.end());
+        FrozenOrderStatisticTree<int> frozen = freeze(ost);
+        
+        // Scattered positions and keys, so successive queries share no path
+        vector<int> positions(queries), probes(queries);
+        for (int q = 0; q < queries; q++) {
+            unsigned long long h = (unsigned long long)(q + 1) * 0x9E3779B97F4A7C15ULL;
+            positions[q] = (int)((h >> 33) % n) + 1;
+            probes[q] = (int)((h >> 17) % (2 * n));
+        }
+        
+        auto timeSelect = [&](auto& tree) {
+            return perOpMicros(queries, [&](bench::Timer& t) {
+                long long sum = 0;
+                t.start();
+                for (int k : positions) {
+                    sum += tree.select(k);
+                }
+                t.stop();
+                bench::doNotOptimize(sum);
+            });
+        };
+        auto timeRank = [&](auto& tree) {
+            return perOpMicros(queries, [&](bench::Timer& t) {
+                long long sum = 0;
+                t.start();
+                for (int key : probes) {
+                    sum += tree.rankOf(key);
+                }
+                t.stop();
+                bench::doNotOptimize(sum);
+            });
+        };
+        bench::Stats ostSelect = timeSelect(ost);
+        bench::Stats frozenSelect = timeSelect(frozen);
+        bench::Stats ostRank = timeRank(ost);
+        bench::Stats btreeRank = timeRank(btree);
+        bench::Stats frozenRank = timeRank(frozen);
+        
+        cout << setw(10) << n;
+        printStat(ostSelect, 15);
+        printStat(frozenSelect, 15);
+        printStat(ostRank, 15);
+        printStat(btreeRank, 15);
+        printStat(frozenRank, 15);
+        cout << "\n";
+        
+        outfile << n << ",";
+        writeStat(outfile, ostSelect);
+        outfile << ",";
+        writeStat(outfile, frozenSelect);
+        outfile << ",";
+        writeStat(outfile, ostRank);
+        outfile << ",";
+        writeStat(outfile, btreeRank);
+        outfile << ",";
+        writeStat(outfile, frozenRank);
+        outfile << "\n";
+    }
+}
+
+// Startup cost: rebuilding with an insert loop vs mapping a snapshot.
+// The file was just written, so open/query times see a warm page cache.
+void benchSnapshotLoad() {
+    cout << "snapshot_load.csv\n";
+    ofstream outfile("results/snapshot_load.csv");
+    outfile << "structure,n," << statColumns("insert_loop_time") << "," << statColumns("write_time") << ","
+            << statColumns("open_query_time") << "," << statColumns("to_tree_time") << "\n";
+    const string path = "results/bench.snap";
+    
+    vector<int> sizes = {100000, 1000000};
+    
+    for (int n : sizes) {
+        vector<int> keys(n);
+        for (int i = 0; i < n; i++) {
+            keys[i] = (int)(((long long)i * 7919) % n);
+        }
+        vector<Interval> intervals;
+        intervals.reserve(n);
+        for (int i = 0; i < n; i++) {
+            intervals.push_back(Interval(keys[i] * 10, keys[i] * 10 + 10, ((i * 17) % 20) - 10));
+        }
+        
+        OrderStatisticTree<int> ost;
+        bench::Stats ostLoop = phaseMicros([&](bench::Timer& t) {
+            OrderStatisticTree<int> fresh;
+            t.start();
+            for (int key : keys) {
+                fresh.insert(key);
+            }
+            t.stop();
+            ost = std::move(fresh);
+        });
+        bench::Stats ostWrite = phaseMicros([&](bench::Timer& t) {
+            t.start();
+            OSTSnapshot<int>::write(path, ost);
+            t.stop();
+        });
+        bench::Stats ostOpen = phaseMicros([&](bench::Timer& t) {
+            t.start();
+            OSTSnapshot<int> snap(path);
+            bench::doNotOptimize(snap.select(n / 2) + snap.rank(n / 3));
+            t.stop();
+        });
+        OSTSnapshot<int> ostSnap(path);
+        bench::Stats ostConvert = phaseMicros([&](bench::Timer& t) {
+            t.start();
+            OrderStatisticTree<int> tree = ostSnap.toTree();
+            t.stop();
+            bench::doNotOptimize(tree.size());
+        });
+        
+        POMTree pom;
+        bench::Stats pomLoop = phaseMicros([&](bench::Timer& t) {
+            POMTree fresh;
+            t.start();
+            for (const auto& iv : intervals) {
+                fresh.insert(iv);
+            }
+            t.stop();
+            pom = std::move(fresh);
+        });
+        bench::Stats pomWrite = phaseMicros([&](bench::Timer& t) {
+            t.start();
+            POMSnapshot::write(path, pom);
+            t.stop();
+        });
+        bench::Stats pomOpen = phaseMicros([&](bench::Timer& t) {
+            t.start();
+            POMSnapshot snap(path);
+            bench::doNotOptimize(snap.findPOM(n * 2, n * 8).maxpref);
+            t.stop();
+        });
+        POMSnapshot pomSnap(path);
+        bench::Stats pomConvert = phaseMicros([&](bench::Timer& t) {
+            t.start();
+            POMTree tree = pomSnap.toTree();
+            t.stop();
+            bench::doNotOptimize(tree.size());
+        });
+        
+        const char* names[] = {"ost", "pom"};
+        const bench::Stats* rows[2][4] = {{&ostLoop, &ostWrite, &ostOpen, &ostConvert},
+                                          {&pomLoop, &pomWrite, &pomOpen, &pomConvert}};
+        for (int r = 0; r < 2; r++) {
+            cout << setw(6) << names[r] << setw(10) << n;
+            outfile << names[r] << "," << n;
+            for (const bench::Stats* stat : rows[r]) {
+                printStat(*stat, 15);
+                outfile << ",";
+                writeStat(outfile, *stat);
+            }
+            cout << "\n";
+            outfile << "\n";
+        }
+    }
+    std::remove(path.c_str());
+}
+
+void benchAblationDepth() {
+    cout << "ablation_depth.csv\n";
+    ofstream outfile("results/ablation_depth.csv");
+    outfile << "n,log2n," << statColumns("avg_select_time") << ",time_per_logn,"
+            << statColumns("compact_select_time") << "," << statColumns("btree_select_time") << ","
+            << statColumns("frozen_select_time") << "\n";
+    
+    vector<int> sizes = {100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000};
+    
+    for (int n : sizes) {
+        vector<int> keys(n);
+        iota(keys.begin(), keys.end(), 0);
+        OrderStatisticTree<int> ost(keys.begin(), keys.end());
+        CompactOrderStatisticTree<int> compact;
+        compact.buildFromSorted(keys.begin(), keys.end());
+        BTreeOrderStatisticTree<int> btree(keys.begin(), keys.end());
+        FrozenOrderStatisticTree<int> frozen = freeze(ost);
+        
+        // Pseudo-random positions, same sequence for every layout
+        int queries = min(1000, n);
+        bench::Stats selectTime = perOpMicros(queries, [&](bench::Timer& t) {
+            t.start();
+            for (int i = 1; i <= queries; i++) {
+                bench::doNotOptimize(ost.select((i * 17) % n + 1));
+            }
+            t.stop();
+        });
+        bench::Stats compactTime = perOpMicros(queries, [&](bench::Timer& t) {
+            t.start();
+            for (int i = 1; i <= queries; i++) {
+                bench::doNotOptimize(compact.select((i * 17) % n + 1));
+            }
+            t.stop();
+        });
+        bench::Stats btreeTime = perOpMicros(queries, [&](bench::Timer& t) {
+            t.start();
+            for (int i = 1; i <= queries; i++) {
+                bench::doNotOptimize(btree.select((i * 17) % n + 1));
+            }
+            t.stop();
+        });
+        bench::Stats frozenTime = perOpMicros(queries, [&](bench::Timer& t) {
+            t.start();
+            for (int i = 1; i <= queries; i++) {
+                bench::doNotOptimize(frozen.select((i * 17) % n + 1));
+            }
+            t.stop();
+        });
+        
+        double log2n = log2(n);
+        double timePerLog = selectTime.median / log2n;
+        
+        cout << setw(10) << n
+             << setw(15) << setprecision(2) << log2n
+             << setw(18) << setprecision(5) << selectTime.median
+             << setw(15) << setprecision(5) << timePerLog
+             << setw(20) << setprecision(5) << compactTime.median
+             << setw(20) << setprecision(5) << btreeTime.median
+             << setw(20) << setprecision(5) << frozenTime.median << "\n";
+        
+        outfile << n << "," << log2n << ",";
+        writeStat(outfile, selectTime);
+        outfile << "," << timePerLog << ",";
+        writeStat(outfile, compactTime);
+        outfile << ",";
+        writeStat(outfile, btreeTime);
+        outfile << ",";
+        writeStat(outfile, frozenTime);
+        outfile << "\n";
+    }
+}
+
+void benchAblationPOMPatterns() {
+    cout << "ablation_pom_patterns.csv\n";
+    ofstream outfile("results/ablation_pom_patterns.csv");
+    outfile << "pattern,n," << statColumns("insert_time") << "," << statColumns("findpom_time") << "\n";
+    
+    int n = 5000;
+    const int queries = 10000;
+    
+    const char* names[3] = {"all_positive", "alternating", "random_like"};
+    for (int p = 0; p < 3; p++) {
+        vector<Interval> workload;
+        for (int i = 0; i < n; i++) {
+            int val = p == 0 ? 5 : p == 1 ? (i % 2 == 0 ? 10 : -5) : ((i * 17) % 20) - 10;
+            workload.push_back(Interval(i * 10, (i + 1) * 10, val));
+        }
+        
+        bench::Stats insertTime = phaseMicros([&](bench::Timer& t) {
+            POMTree pom;
+            t.start();
+            for (const auto& iv : workload) {
+                pom.insert(iv);
+            }
+            t.stop();
+        });
+        
+        POMTree pom;
+        pom.insertBatch(workload.begin(), workload.end());
+        bench::Stats findTime = perOpMicros(queries, [&](bench::Timer& t) {
+            t.start();
+            for (int i = 0; i < queries; i++) {
+                bench::doNotOptimize(pom.findPOM());
+            }
+            t.stop();
+        });
+        
+        cout << setw(20) << names[p] << setw(12) << n;
+        printStat(insertTime, 15);
+        cout << setw(15) << setprecision(5) << findTime.median << "\n";
+        
+        outfile << names[p] << "," << n << ",";
+        writeStat(outfile, insertTime);
+        outfile << ",";
+        writeStat(outfile, findTime);
+        outfile << "\n";
+    }
+}
+
+void benchWorkloads() {
+    cout << "workloads.csv\n";
+    ofstream outfile("results/workloads.csv");
+    outfile << "pattern,read_percent,n,ops," << statColumns("ost_time") << ","
+            << statColumns("compact_time") << "," << statColumns("btree_time") << ","
+            << statColumns("pom_time") << "\n";
+    
+    const int n = 20000, ops = 20000;
+    WorkloadPattern patterns[4] = {WORKLOAD_UNIFORM, WORKLOAD_ZIPF, WORKLOAD_REVERSE, WORKLOAD_SLIDING_WINDOW};
+    int readPercents[3] = {10, 50, 90};
+    
+    for (WorkloadPattern pattern : patterns) {
+        for (int readPercent : readPercents) {
+            Workload w = WorkloadGenerator::make(WorkloadConfig(pattern, n, ops, readPercent));
+            long long expected = 0, checksum = 0;
+            
+            // Per operation, excluding the preload
+            bench::Stats ostTime = perOpMicros(ops, [&](bench::Timer& t) {
+                OrderStatisticTree<int> ost;
+                loadOrderStatistic(ost, w);
+                t.start();
+                expected = replayOrderStatistic(ost, w);
+                t.stop();
+            });
+            bench::Stats compactTime = perOpMicros(ops, [&](bench::Timer& t) {
+                CompactOrderStatisticTree<int> compact;
+                compact.reserve(n + ops);
+                loadOrderStatistic(compact, w);
+                t.start();
+                checksum = replayOrderStatistic(compact, w);
+                t.stop();
+            });
+            long long btreeChecksum = 0;
+            bench::Stats btreeTime = perOpMicros(ops, [&](bench::Timer& t) {
+                BTreeOrderStatisticTree<int> btree;
+                loadOrderStatistic(btree, w);
+                t.start();
+                btreeChecksum = replayOrderStatistic(btree, w);
+                t.stop();
+            });
+            bench::Stats pomTime = perOpMicros(ops, [&](bench::Timer& t) {
+                POMTree pom;
+                loadPOM(pom, w);
+                t.start();
+                bench::doNotOptimize(replayPOM(pom, w));
+                t.stop();
+            });
+            if (checksum != expected || btreeChecksum != expected) {
+                cout << "  checksum mismatch: OST " << expected << ", compact " << checksum
+                     << ", B-tree " << btreeChecksum << "\n";
+            }
+            
+            cout << setw(16) << WorkloadGenerator::patternName(pattern) << setw(6) << readPercent << "%"
+                 << setw(12) << setprecision(4) << ostTime.median
+                 << setw(12) << compactTime.median
+                 << setw(12) << btreeTime.median
+                 << setw(12) << pomTime.median << "\n";
+            
+            outfile << WorkloadGenerator::patternName(pattern) << "," << readPercent << ","
+                    << n << "," << ops << ",";
+            writeStat(outfile, ostTime);
+            outfile << ",";
+            writeStat(outfile, compactTime);
+            outfile << ",";
+            writeStat(outfile, btreeTime);
+            outfile << ",";
+            writeStat(outfile, pomTime);
+            outfile << "\n";
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) config.trials = max(1, atoi(argv[1]));
+    if (argc > 2) config.warmup = max(0, atoi(argv[2]));
+    
+    system("mkdir -p results");
+    cout << "Benchmarking with " << config.warmup << " warmup and " << config.trials
+         << " timed trials (medians in μs)\n\n";
+    
+    benchOSTPerformance();
+    benchJosephusComparison();
+    benchJosephusParallel();
+    benchJosephusAdaptive();
+    benchPOMPerformance();
+    benchPOMUpdateModes();
+    benchPOMRemoveLookup();
+    benchPOMRangeAdd();
+    benchPOMSubarray();
+    benchPersistentPOM();
+    benchSnapshotLoad();
+    benchBlockedPOM();
+    benchAblationM();
+    benchAblationDepth();
+    benchFrozenOST();
+    benchOSTIteration();
+    benchOSTSelectMany();
+    benchAblationPOMPatterns();
+    benchWorkloads();
+    benchConcurrentReads();
+    
+    cout << "\nResults saved to results/\n";
+    return 0;
+}
@@ -0,0 +1,168 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Micro-benchmark harness
+ * Runs a measured body for a number of warmup rounds (discarded) and
+ * then a number of timed trials, and summarizes the per-operation cost:
+ * - nanosecond steady_clock timing around only the region the body marks
+ * - median, mean, min, max, p95 and p99 over the trials
+ * - a distribution-free 95% confidence interval for the median, taken
+ *   from the order statistics of the sorted trials (binomial bound)
+ *
+ * The body receives a Timer and calls start()/stop() around the work it
+ * wants measured, so per-trial setup (building a tree to delete from,
+ * say) stays outside the measurement. Results that would otherwise be
+ * unused must go through doNotOptimize() so the work is not removed.
+ */
+
+namespace bench {
+
+#if defined(__GNUC__) || defined(__clang__)
+// Make the optimizer assume `value` is read, and memory is clobbered
+template<typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+inline void clobberMemory() {
+    asm volatile("" : : : "memory");
+}
+#else
+template<typename T>
+inline void doNotOptimize(const T& value) {
+    static const void* volatile sink;
+    sink = &value;
+}
+
+inline void clobberMemory() {}
+#endif
+
+class Timer {
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    Clock::time_point begin;
+    std::int64_t total;   // Accumulated nanoseconds over start/stop pairs
+
+public:
+    Timer() : total(0) {}
+    
+    void start() {
+        clobberMemory();
+        begin = Clock::now();
+    }
+    
+    void stop() {
+        auto end = Clock::now();
+        clobberMemory();
+        total += std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+    }
+    
+    std::int64_t nanoseconds() const {
+        return total;
+    }
+};
+
+struct Config {
+    int warmup;
+    int trials;
+    
+    Config(int warmup = 3, int trials = 15) : warmup(warmup), trials(trials) {}
+};
+
+// Per-operation nanoseconds over the timed trials
+struct Stats {
+    double median;
+    double mean;
+    double min;
+    double max;
+    double p95;
+    double p99;
+    double ciLow;      // 95% confidence interval for the median
+    double ciHigh;
+    int trials;
+    
+    Stats() : median(0), mean(0), min(0), max(0), p95(0), p99(0),
+              ciLow(0), ciHigh(0), trials(0) {}
+    
+    // Same statistics in another unit (1e-3 for microseconds)
+    Stats scaled(double factor) const {
+        Stats s = *this;
+        s.median *= factor;
+        s.mean *= factor;
+        s.min *= factor;
+        s.max *= factor;
+        s.p95 *= factor;
+        s.p99 *= factor;
+        s.ciLow *= factor;
+        s.ciHigh *= factor;
+        return s;
+    }
+};
+
+// Nearest-rank percentile of an already sorted, non-empty sample
+inline double percentile(const std::vector<double>& sorted, double p) {
+    int n = (int)sorted.size();
+    int rank = (int)std::ceil(p / 100.0 * n);
+    rank = std::max(1, std::min(n, rank));
+    return sorted[rank - 1];
+}
+
+inline Stats summarize(std::vector<double> samples) {
+    Stats s;
+    int n = (int)samples.size();
+    if (n == 0) return s;
+    
+    std::sort(samples.begin(), samples.end());
+    s.trials = n;
+    s.min = samples.front();
+    s.max = samples.back();
+    s.median = n % 2 == 1 ? samples[n / 2]
+                          : (samples[n / 2 - 1] + samples[n / 2]) / 2.0;
+    double sum = 0;
+    for (double v : samples) sum += v;
+    s.mean = sum / n;
+    s.p95 = percentile(samples, 95);
+    s.p99 = percentile(samples, 99);
+    
+    // The rank of the true median among n samples is Binomial(n, 1/2);
+    // the normal approximation gives the 1-indexed ranks bracketing it
+    double half = 1.96 * std::sqrt((double)n) / 2.0;
+    int lo = (int)std::floor(n / 2.0 - half);
+    int hi = (int)std::ceil(n / 2.0 + half) + 1;
+    lo = std::max(1, lo);
+    hi = std::min(n, hi);
+    s.ciLow = samples[lo - 1];
+    s.ciHigh = samples[hi - 1];
+    return s;
+}
+
+// Run body(Timer&) cfg.warmup + cfg.trials times. Each timed trial
+// contributes its measured nanoseconds divided by opsPerTrial.
+template<typename Body>
+Stats run(const Config& cfg, double opsPerTrial, Body body) {
+    for (int i = 0; i < cfg.warmup; i++) {
+        Timer timer;
+        body(timer);
+    }
+    
+    std::vector<double> samples;
+    samples.reserve(cfg.trials);
+    for (int i = 0; i < cfg.trials; i++) {
+        Timer timer;
+        body(timer);
+        samples.push_back((double)timer.nanoseconds() / opsPerTrial);
+    }
+    return summarize(samples);
+}
+
+} // namespace bench
+
+#endif // BENCH_H
@@ -0,0 +1,103 @@
+#ifndef FENWICK_H
+#define FENWICK_H
+
+#include <vector>
+#include <stdexcept>
+
+/**
+ * Fenwick Tree (Binary Indexed Tree) over positions 0..n-1
+ * Each position holds a count (0 or 1 for a set of alive positions).
+ * Supports over a flat array:
+ * - add / prefix count: O(log n)
+ * - eraseAt (find AND remove the k-th present position): one O(log n)
+ *   binary-lifting pass, no key comparisons and no pointer chasing
+ */
+
+class FenwickTree {
+private:
+    std::vector<int> tree;  // 1-indexed, tree[i] covers (i - lowbit(i), i]
+    int n;
+    int topStep;            // Highest power of two <= n
+    int total;
+
+public:
+    // Start with every position present (count 1), built in O(n)
+    explicit FenwickTree(int n) : tree(n + 1, 0), n(n), topStep(1), total(n) {
+        for (int i = 1; i <= n; i++) {
+            tree[i] = i & -i;
+        }
+        while (topStep * 2 <= n) {
+            topStep *= 2;
+        }
+    }
+
+    void add(int pos, int delta) {
+        total += delta;
+        for (int i = pos + 1; i <= n; i += i & -i) {
+            tree[i] += delta;
+        }
+    }
+
+    // Count of present positions in [0, pos]
+    int prefix(int pos) const {
+        int sum = 0;
+        for (int i = pos + 1; i > 0; i -= i & -i) {
+            sum += tree[i];
+        }
+        return sum;
+    }
+
+    // Remove the k-th present position (1-indexed) and return it.
+    // Every node the descent does NOT skip over covers the target, and
+    // those are exactly the nodes an add(target, -1) would touch, so they
+    // are decremented on the way down.
+    int eraseAt(int k) {
+        if (k < 1 || k > total) {
+            throw std::out_of_range("Index out of range");
+        }
+
+        int pos = 0;
+        for (int step = topStep; step > 0; step >>= 1) {
+            int next = pos + step;
+            if (next > n) continue;
+            if (tree[next] < k) {
+                pos = next;
+                k -= tree[next];
+            } else {
+                tree[next]--;
+            }
+        }
+        total--;
+        return pos;
+    }
+
+    // Positions still present, in increasing order, in O(n): undoing the
+    // O(n) build from the top recovers each position's own count
+    std::vector<int> present() const {
+        std::vector<int> count(tree);
+        for (int i = n; i >= 1; i--) {
+            int parent = i + (i & -i);
+            if (parent <= n) {
+                count[parent] -= count[i];
+            }
+        }
+        std::vector<int> positions;
+        positions.reserve(total);
+        for (int i = 1; i <= n; i++) {
+            if (count[i] > 0) {
+                positions.push_back(i - 1);
+            }
+        }
+        return positions;
+    }
+
+    int size() const {
+        return total;
+    }
+
+    bool empty() const {
+        return total == 0;
+    }
+};
+
+#endif // FENWICK_H
@@ -2,8 +2,14 @@
 #define JOSEPHUS_H
 
 #include "ost.h"
+#include "fenwick.h"
+#include "ost_btree.h"
 #include <vector>
+#include <numeric>
 #include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
 
 /**
  * Josephus Permutation Generator
@@ -14,30 +20,539 @@
  * 
  * Naive approach: O(n*m) using array simulation
  * OST approach: O(n log n) using select and delete operations
+ * Fenwick approach: O(n log n) using fused select-and-delete on a flat array
+ * Parallel approach: whole laps of eliminations per multi-threaded pass
+ * Adaptive approach: laps, then Fenwick, then a compact array, switching
+ *   where a calibrated cost model says the next engine is cheaper
+ *
+ * The OST approach takes the tree as a template parameter, so any backend
+ * with buildFromSorted/select/remove/size (OrderStatisticTree,
+ * CompactOrderStatisticTree, BTreeOrderStatisticTree) can run it.
  */
 
+/**
+ * Cost model for JosephusPermutation::generate(): nanoseconds per unit of
+ * work of each engine, so each can be priced per elimination at circle
+ * size s:
+ *   lap     (lapEntry * s + lapRemoval * k) / k, where one lap removes
+ *           k = about s/m people
+ *   Fenwick fenwickLevel * (bit length of s)
+ *   array   shiftErase + shiftEntry * s / 2 (an erase moves half the
+ *           array on average)
+ * The defaults come from JosephusPermutation::calibrate() on the benchmark
+ * machine; bench writes the local values to results/josephus_cost_model.csv.
+ */
+struct JosephusCostModel {
+    double lapEntry;      // Survivor copied while compacting
+    double lapRemoval;    // Removal: its label gathered, a run boundary
+    double fenwickLevel;  // One level of eraseAt
+    double shiftErase;    // One array erase, besides moving entries
+    double shiftEntry;    // One entry moved by an array erase
+    
+    JosephusCostModel()
+        : lapEntry(0.45), lapRemoval(11.0), fenwickLevel(15.5), shiftErase(24.0), shiftEntry(0.035) {}
+    
+    double lap(int size, int m) const {
+        int p = (m - 1) % size;  // A lap starting at offset 0 removes the most
+        double removed = (size - 1 - p) / m + 1;
+        return lapEntry * size / removed + lapRemoval;
+    }
+    
+    double fenwick(int size) const {
+        int levels = 1;
+        for (int i = size; i > 1; i >>= 1) {
+            levels++;
+        }
+        return fenwickLevel * levels;
+    }
+    
+    double shift(int size) const {
+        return shiftErase + shiftEntry * size / 2;
+    }
+    
+    // Circle size from which on the Fenwick tree beats the array. Searched
+    // from the top: at a handful of people the fixed cost of an erase can
+    // make the array look dearer again, but that tail is not worth a switch.
+    int fenwickFrom() const {
+        int hi = 1 << 30;
+        if (!(fenwick(hi) < shift(hi))) {
+            return hi;
+        }
+        while (hi > 1 && fenwick(hi / 2) < shift(hi / 2)) {
+            hi /= 2;
+        }
+        int lo = hi / 2;  // The array wins at lo (or lo = 0)
+        while (hi - lo > 1) {
+            int mid = lo + (hi - lo) / 2;
+            if (fenwick(mid) < shift(mid)) {
+                hi = mid;
+            } else {
+                lo = mid;
+            }
+        }
+        return hi;
+    }
+};
+
 class JosephusPermutation {
 public:
+    using CostModel = JosephusCostModel;
+    
     // Generate Josephus permutation using OST (efficient)
-    static std::vector<int> generateOST(int n, int m) {
-        OrderStatisticTree<int> ost;
+    // Labels and counts use the tree's value_type and size_type, so e.g.
+    // OrderStatisticTree<long long, long long> runs n beyond 2^31 - 1
+    template<typename Tree = OrderStatisticTree<int>>
+    static std::vector<typename Tree::value_type> generateOST(typename Tree::size_type n,
+                                                              typename Tree::size_type m) {
+        std::vector<typename Tree::value_type> result;
+        result.reserve(n);
+        runOST<Tree>(n, m, [&](typename Tree::value_type person) { result.push_back(person); });
+        return result;
+    }
+    
+    // Generate Josephus permutation using a Fenwick tree (positional only)
+    // Each elimination is a single eraseAt pass: no key search for remove
+    static std::vector<int> generateFenwick(int n, int m) {
+        std::vector<int> result;
+        result.reserve(n);
+        runFenwick(n, m, [&](int person) { result.push_back(person); });
+        return result;
+    }
+    
+    // Generate Josephus permutation using naive approach (for comparison)
+    static std::vector<int> generateNaive(int n, int m) {
+        std::vector<int> result;
+        result.reserve(n);
+        runNaive(n, m, [&](int person) { result.push_back(person); });
+        return result;
+    }
+    
+    /**
+     * Streaming variants
+     * Instead of returning the whole permutation, hand eliminations to
+     * sink(const int* first, const int* last) in chunks of up to chunkSize,
+     * in elimination order. Peak memory is the structure plus one chunk,
+     * and the consumer sees output while the run continues. The chunk
+     * pointers are only valid during the call.
+     */
+    template<typename Tree = OrderStatisticTree<int>, typename Sink>
+    static void generateOST(typename Tree::size_type n, typename Tree::size_type m, Sink sink,
+                            int chunkSize = DEFAULT_CHUNK) {
+        ChunkedSink<Sink, typename Tree::value_type> out(sink, chunkSize);
+        runOST<Tree>(n, m, out);
+        out.flush();
+    }
+    
+    template<typename Sink>
+    static void generateFenwick(int n, int m, Sink sink, int chunkSize = DEFAULT_CHUNK) {
+        ChunkedSink<Sink> out(sink, chunkSize);
+        runFenwick(n, m, out);
+        out.flush();
+    }
+    
+    template<typename Sink>
+    static void generateNaive(int n, int m, Sink sink, int chunkSize = DEFAULT_CHUNK) {
+        ChunkedSink<Sink> out(sink, chunkSize);
+        runNaive(n, m, out);
+        out.flush();
+    }
+    
+    /**
+     * Survivor and tail queries without building the permutation
+     * Positions and conventions match generateOST: people 0..n-1, counting
+     * starts at 0, and the survivor is the last element of the permutation.
+     *
+     * survivorLinear: O(n) time via J(1) = 0, J(i) = (J(i-1) + m) mod i
+     * survivorJump:   O(m log n) time, O(1) memory; the recurrence only
+     *                 wraps about once every i/(m-1) steps, so each run
+     *                 of non-wrapping steps is applied in one jump
+     * survivor:       picks between the two from n and m
+     * eliminationRank: 1-indexed step at which `person` is eliminated,
+     *                 O(m log n) time by the same pass skipping, O(1) memory
+     * lastEliminated: the final k entries of the permutation, in order
+     */
+    static long long survivorLinear(long long n, long long m) {
+        checkQuery(n, m);
+        long long pos = 0;
+        for (long long i = 2; i <= n; i++) {
+            pos = (pos + m) % i;
+        }
+        return pos;
+    }
+    
+    static long long survivorJump(long long n, long long m) {
+        checkQuery(n, m);
+        return liftPosition(0, 1, n, m);
+    }
+    
+    static long long survivor(long long n, long long m) {
+        checkQuery(n, m);
+        // The jump variant costs about m * ln(n / m) + m steps
+        long long logN = 1;
+        for (long long i = n; i > 1; i >>= 1) {
+            logN++;
+        }
+        if (m <= n / logN) {
+            return liftPosition(0, 1, n, m);
+        }
+        return survivorLinear(n, m);
+    }
+    
+    static long long eliminationRank(long long n, long long m, long long person) {
+        checkQuery(n, m);
+        if (person < 0 || person >= n) {
+            throw std::out_of_range("Index out of range");
+        }
+        if (m == 1) {
+            return person + 1;
+        }
         
-        // Initialize tree with positions 0 to n-1
-        for (int i = 0; i < n; i++) {
-            ost.insert(i);
+        // pos is the person's offset from the current starting point
+        long long i = n, pos = person, done = 0;
+        while (true) {
+            if (i >= m) {
+                // Full pass: offsets m-1, 2m-1, ..., cm-1 go, and the next
+                // circle starts at offset cm
+                long long c = i / m;
+                if (pos < c * m && (pos + 1) % m == 0) {
+                    return done + (pos + 1) / m;
+                }
+                pos = pos >= c * m ? pos - c * m : (i - c * m) + pos - (pos + 1) / m;
+                done += c;
+                i -= c;
+            } else {
+                long long e = (m - 1) % i;
+                if (pos == e) {
+                    return done + 1;
+                }
+                pos = pos > e ? pos - e - 1 : pos + i - e - 1;
+                done++;
+                i--;
+            }
+        }
+    }
+    
+    static std::vector<long long> lastEliminated(long long n, long long m, long long k) {
+        checkQuery(n, m);
+        if (k < 0 || k > n) {
+            throw std::out_of_range("Index out of range");
+        }
+        std::vector<long long> result;
+        result.reserve(k);
+        // With j people left, offset (m-1) mod j of that circle goes next
+        for (long long j = k; j >= 1; j--) {
+            result.push_back(m == 1 ? n - j : liftPosition((m - 1) % j, j, n, m));
         }
+        return result;
+    }
         
-        std::vector<int> result;
+    /**
+     * Parallel Josephus permutation over a flat array, lap by lap
+     * The alive people sit in a sorted array A of size s. Counting from
+     * offset `current`, one lap eliminates A[p], A[p + m], A[p + 2m], ...
+     * up to the end of the array, where p = (current + m - 1) mod s, since
+     * each removal shifts the later ranks down by one. Those positions are
+     * known up front, so threads gather the lap's labels and compact the
+     * survivors into a second buffer independently: a survivor's new index
+     * is its old one minus the removals before it, in closed form.
+     *
+     * A lap costs O(s / threads) for about s/m eliminations, so laps pay
+     * off while m is small next to threads * log s. Once they stop paying
+     * (or fewer than m people remain and a lap removes one person), the
+     * rest runs on a Fenwick tree over the remaining array. The output is
+     * identical to generateNaive. threads = 0 uses every hardware thread.
+     */
+    static std::vector<int> generateParallel(int n, int m, int threads = 0) {
+        if (threads <= 0) {
+            threads = std::max(1, (int)std::thread::hardware_concurrency());
+        }
+        std::vector<int> alive(n), next(n);
+        std::iota(alive.begin(), alive.end(), 0);
+        std::vector<int> result(n);
+        
+        int size = n;
+        int done = 0;
         int current = 0;
         
+        while (size > 0 && lapPaysOff(size, m, threads)) {
+            done += runLap(alive, next, result.data() + done, size, current, m, threads);
+        }
+        
+        if (size > 0) {
+            FenwickTree rest(size);
+            while (size > 0) {
+                current = (int)((current + (long long)m - 1) % size);
+                result[done++] = alive[rest.eraseAt(current + 1)];
+                size--;
+                if (size > 0) {
+                    current %= size;
+                }
+            }
+        }
+        
+        return result;
+    }
+    
+    // Time each engine's unit of work on this machine, in a few milliseconds
+    static CostModel calibrate() {
+        using Clock = std::chrono::steady_clock;
+        auto nanos = [](Clock::time_point start) {
+            return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        };
+        const int size = 1 << 20;
+        const int rounds = 3;
+        CostModel model;
+        model.fenwickLevel = 1e18;
+        double sparseLap = 1e18, denseLap = 1e18;  // Per entry at m = 256 and m = 2
+        double shiftCost[2] = {1e18, 1e18}, shiftMoved[2] = {0, 0};
+        std::vector<int> out(size);
+        for (int round = 0; round < rounds; round++) {
+            std::vector<int> alive(size), next(size);
+            for (int m : {256, 2}) {
+                std::iota(alive.begin(), alive.end(), 0);
+                int left = size, current = 0;
+                auto start = Clock::now();
+                runLap(alive, next, out.data(), left, current, m, 1);
+                double& best = m == 2 ? denseLap : sparseLap;
+                best = std::min(best, nanos(start) / size);
+            }
+            std::iota(alive.begin(), alive.end(), 0);
+            
+            const int erases = 1 << 14;
+            FenwickTree tree(size);
+            unsigned x = 2463534242u;
+            long long sum = 0;
+            auto start = Clock::now();
+            for (int i = 0; i < erases; i++) {
+                x ^= x << 13;
+                x ^= x >> 17;
+                x ^= x << 5;
+                sum += tree.eraseAt((int)(x % (unsigned)tree.size()) + 1);
+            }
+            model.fenwickLevel = std::min(model.fenwickLevel, nanos(start) / erases / levelsOf(size));
+            out[0] = (int)sum;
+            
+            // Erase half of a narrow and of a wide array: per erase, each
+            // costs shiftErase + shiftEntry * (entries moved)
+            for (int k = 0; k < 2; k++) {
+                int width = k == 0 ? 256 : 8192;
+                std::vector<int> array(alive.begin(), alive.begin() + width);
+                long long moved = 0;
+                start = Clock::now();
+                for (int held = width; held > width / 2; held--) {
+                    int at = (int)((x = x * 1664525u + 1013904223u) % (unsigned)held);
+                    array.erase(array.begin() + at);
+                    moved += held - at;
+                }
+                double perErase = nanos(start) / (width / 2);
+                out[1 + k] = array[0];
+                shiftCost[k] = std::min(shiftCost[k], perErase);
+                shiftMoved[k] = (double)moved / (width / 2);
+            }
+        }
+        model.shiftEntry = std::max(0.0, (shiftCost[1] - shiftCost[0]) / (shiftMoved[1] - shiftMoved[0]));
+        model.shiftErase = std::max(0.0, shiftCost[0] - model.shiftEntry * shiftMoved[0]);
+        // Per entry, a lap costs lapEntry + lapRemoval / m
+        model.lapRemoval = std::max(0.0, (denseLap - sparseLap) / (0.5 - 1.0 / 256));
+        model.lapEntry = std::max(0.0, sparseLap - model.lapRemoval / 256);
+        return model;
+    }
+    
+    /**
+     * Josephus permutation with the engine picked by a cost model
+     * The circle runs on the cheapest engine for its current size and
+     * moves on as it shrinks, always in this order:
+     *   1. compacting laps (the closed-form pass of generateParallel, on
+     *      one thread) while m is small against log s;
+     *   2. a Fenwick tree over the survivors while log s beats s / 2;
+     *   3. a compact array, erasing from it, once few people remain.
+     * For m = 1 the first lap is the whole permutation. Each switch costs
+     * one O(s) pass over the survivors. generateNaive and generateOST are
+     * never picked, since laps and the Fenwick tree beat them at every
+     * (n, m) in the benchmarks. The output is identical to generateNaive.
+     */
+    static std::vector<int> generate(int n, int m, const CostModel& model = CostModel()) {
+        if (n <= 0) {
+            return {};
+        }
+        checkQuery(n, m);
+        std::vector<int> result(n);
+        std::vector<int> alive;  // Survivors in circle order, once relabeled
+        
+        int size = n;
+        int done = 0;
+        int current = 0;
+        
+        auto lapWins = [&]() {
+            return model.lap(size, m) <= std::min(model.fenwick(size), model.shift(size));
+        };
+        if (lapWins()) {
+            alive.resize(n);
+            std::iota(alive.begin(), alive.end(), 0);
+            std::vector<int> next(n);
+            while (size > 0 && lapWins()) {
+                done += runLap(alive, next, result.data() + done, size, current, m, 1);
+            }
+            alive.resize(size);
+        }
+        
+        int fenwickFrom = model.fenwickFrom();
+        if (size >= fenwickFrom) {
+            // Until a lap has run, labels are positions and need no lookup
+            bool relabeled = !alive.empty();
+            FenwickTree rest(size);
+            while (size >= fenwickFrom) {
+                current = (int)((current + (long long)m - 1) % size);
+                int at = rest.eraseAt(current + 1);
+                result[done++] = relabeled ? alive[at] : at;
+                size--;
+                if (size > 0) {
+                    current %= size;
+                }
+            }
+            // Keep the survivors in order, so current stays valid
+            std::vector<int> survivors = rest.present();
+            if (relabeled) {
+                for (int& at : survivors) {
+                    at = alive[at];
+                }
+            }
+            alive.swap(survivors);
+        } else if (alive.empty()) {
+            alive.resize(size);
+            std::iota(alive.begin(), alive.end(), 0);
+        }
+        
+        while (size > 0) {
+            current = (int)((current + (long long)m - 1) % size);
+            result[done++] = alive[current];
+            alive.erase(alive.begin() + current);
+            size--;
+            if (size > 0) {
+                current %= size;
+            }
+        }
+        
+        return result;
+    }
+    
+    // Benchmark OST approach
+    template<typename Tree = OrderStatisticTree<int>>
+    static long long benchmarkOST(int n, int m) {
+        auto start = std::chrono::high_resolution_clock::now();
+        generateOST<Tree>(n, m);
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    }
+    
+    // Benchmark Fenwick approach
+    static long long benchmarkFenwick(int n, int m) {
+        auto start = std::chrono::high_resolution_clock::now();
+        generateFenwick(n, m);
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    }
+    
+    // Benchmark naive approach
+    static long long benchmarkNaive(int n, int m) {
+        auto start = std::chrono::high_resolution_clock::now();
+        generateNaive(n, m);
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    }
+    
+    // Verify that all approaches produce the same result
+    static bool verify(int n, int m) {
+        std::vector<int> resultOST = generateOST(n, m);
+        std::vector<int> resultNaive = generateNaive(n, m);
+        std::vector<int> resultFenwick = generateFenwick(n, m);
+        std::vector<int> resultBTree = generateOST<BTreeOrderStatisticTree<int>>(n, m);
+        std::vector<int> resultParallel = generateParallel(n, m);
+        std::vector<int> resultAdaptive = generate(n, m);
+        std::vector<int> resultStreamed;
+        generateOST(n, m, [&](const int* first, const int* last) {
+            resultStreamed.insert(resultStreamed.end(), first, last);
+        }, 3);
+        return resultOST == resultNaive && resultFenwick == resultNaive &&
+               resultBTree == resultNaive && resultParallel == resultNaive &&
+               resultAdaptive == resultNaive &&
+               resultStreamed == resultNaive &&
+               verifyQueries(n, m, resultNaive);
+    }
+    
+    // Check the survivor and tail queries against a full permutation
+    static bool verifyQueries(int n, int m, const std::vector<int>& permutation) {
+        if (permutation.empty()) {
+            return true;
+        }
+        if (survivorLinear(n, m) != permutation.back() ||
+            survivorJump(n, m) != permutation.back()) {
+            return false;
+        }
+        for (int step = 0; step < n; step++) {
+            if (eliminationRank(n, m, permutation[step]) != step + 1) {
+                return false;
+            }
+        }
+        std::vector<long long> tail = lastEliminated(n, m, n);
+        return std::equal(tail.begin(), tail.end(), permutation.begin());
+    }
+
+private:
+    static const int DEFAULT_CHUNK = 4096;
+    
+    // Buffers single eliminations and passes them to the sink in chunks
+    template<typename Sink, typename Value = int>
+    class ChunkedSink {
+    private:
+        Sink& sink;
+        std::vector<Value> buffer;
+        size_t capacity;
+        
+    public:
+        ChunkedSink(Sink& sink, int chunkSize) : sink(sink), capacity(std::max(1, chunkSize)) {
+            buffer.reserve(capacity);
+        }
+        
+        void operator()(Value person) {
+            buffer.push_back(person);
+            if (buffer.size() == capacity) {
+                flush();
+            }
+        }
+        
+        void flush() {
+            if (!buffer.empty()) {
+                sink(buffer.data(), buffer.data() + buffer.size());
+                buffer.clear();
+            }
+        }
+    };
+    
+    // The elimination loops; emit(person) receives each elimination in order
+    template<typename Tree, typename Emit>
+    static void runOST(typename Tree::size_type n, typename Tree::size_type m, Emit&& emit) {
+        using Key = typename Tree::value_type;
+        using Size = typename Tree::size_type;
+        
+        // Initialize tree with positions 0 to n-1 (linear-time bulk build)
+        Tree ost;
+        {
+            std::vector<Key> positions(n);
+            std::iota(positions.begin(), positions.end(), Key(0));
+            ost.buildFromSorted(positions.begin(), positions.end());
+        }
+        
+        Size current = 0;
+        
         while (!ost.empty()) {
             // Calculate next position to eliminate
             current = (current + m - 1) % ost.size();
             
             // Select and remove the element at position (current + 1)
             // +1 because select is 1-indexed
-            int eliminated = ost.select(current + 1);
-            result.push_back(eliminated);
+            Key eliminated = ost.select(current + 1);
+            emit(eliminated);
             ost.remove(eliminated);
             
             // Update current position for next iteration
@@ -45,14 +560,22 @@ public:
                 current = current % ost.size();
             }
         }
+    }
+    
+    template<typename Emit>
+    static void runFenwick(int n, int m, Emit&& emit) {
+        FenwickTree alive(n);
+        int current = 0;
         
-        return result;
+        while (!alive.empty()) {
+            current = (current + m - 1) % alive.size();
+            emit(alive.eraseAt(current + 1));
+        }
     }
     
-    // Generate Josephus permutation using naive approach (for comparison)
-    static std::vector<int> generateNaive(int n, int m) {
+    template<typename Emit>
+    static void runNaive(int n, int m, Emit&& emit) {
         std::vector<bool> alive(n, true);
-        std::vector<int> result;
         
         int current = 0;
         int remaining = n;
@@ -71,7 +594,7 @@ public:
             
             // Eliminate current person
             alive[current] = false;
-            result.push_back(current);
+            emit(current);
             remaining--;
             
             // Move to next alive person
@@ -82,31 +605,123 @@ public:
                 }
             }
         }
+    }
+    
+    static void checkQuery(long long n, long long m) {
+        if (n < 1 || m < 1) {
+            throw std::invalid_argument("Josephus requires n >= 1 and m >= 1");
+        }
+    }
+    
+    // A lap touches all `size` entries for about size/m eliminations; the
+    // Fenwick tail misses cache about log(size) times per elimination
+    static bool lapPaysOff(int size, int m, int threads) {
+        if (size < m) {
+            return false;
+        }
+        return (long long)m <= 24LL * threads * levelsOf(size);
+    }
+    
+    // One lap over the `size` people in alive: write its eliminations to out,
+    // compact the survivors (via next, which is swapped in) and move current
+    // to where counting resumes. Returns the number eliminated.
+    static int runLap(std::vector<int>& alive, std::vector<int>& next, int* out,
+                      int& size, int& current, int m, int threads) {
+        int p = (int)((current + (long long)m - 1) % size);
+        int count = (size - 1 - p) / m + 1;
         
-        return result;
+        const int* src = alive.data();
+        int* dst = next.data();
+        parallelFor(threads, count, [=](int lo, int hi) {
+            for (int j = lo; j < hi; j++) {
+                out[j] = src[p + (long long)j * m];
+            }
+        });
+        parallelFor(threads, size, [=](int lo, int hi) {
+            compactLap(src, dst, lo, hi, p, m);
+        });
+        
+        alive.swap(next);
+        size -= count;
+        // Counting resumes just after the last person removed
+        current = size > 0 ? (p + (count - 1) * m - (count - 1)) % size : 0;
+        return count;
     }
     
-    // Benchmark OST approach
-    static long long benchmarkOST(int n, int m) {
-        auto start = std::chrono::high_resolution_clock::now();
-        generateOST(n, m);
-        auto end = std::chrono::high_resolution_clock::now();
-        return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    // Levels of a Fenwick descent over `size` positions: bit length of size
+    static int levelsOf(int size) {
+        int levels = 1;
+        for (int i = size; i > 1; i >>= 1) {
+            levels++;
+        }
+        return levels;
     }
     
-    // Benchmark naive approach
-    static long long benchmarkNaive(int n, int m) {
-        auto start = std::chrono::high_resolution_clock::now();
-        generateNaive(n, m);
-        auto end = std::chrono::high_resolution_clock::now();
-        return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    // Copy the survivors of one lap from src[lo, hi) to their new slots:
+    // src[p + j*m] is removed, so the runs between removals close up
+    static void compactLap(const int* src, int* dst, int lo, int hi, int p, int m) {
+        int i = lo;
+        if (i < p) {
+            int end = std::min(hi, p);
+            std::copy(src + i, src + end, dst + i);
+            i = end;
+        }
+        while (i < hi) {
+            int j = (i - p) / m;
+            if ((i - p) % m == 0) {
+                i++;
+                continue;
+            }
+            int end = (int)std::min<long long>(hi, p + (long long)(j + 1) * m);
+            std::copy(src + i, src + end, dst + i - (j + 1));
+            i = end;
+        }
     }
     
-    // Verify that both approaches produce the same result
-    static bool verify(int n, int m) {
-        std::vector<int> resultOST = generateOST(n, m);
-        std::vector<int> resultNaive = generateNaive(n, m);
-        return resultOST == resultNaive;
+    // Split [0, count) into one contiguous chunk per thread; the calling
+    // thread takes the first. Small ranges are not worth a thread launch.
+    template<typename Body>
+    static void parallelFor(int threads, int count, Body body) {
+        const int minChunk = 1 << 14;
+        int chunks = std::min(threads, std::max(1, count / minChunk));
+        if (chunks <= 1) {
+            body(0, count);
+            return;
+        }
+        std::vector<std::thread> workers;
+        workers.reserve(chunks - 1);
+        for (int c = 1; c < chunks; c++) {
+            int lo = (int)((long long)count * c / chunks);
+            int hi = (int)((long long)count * (c + 1) / chunks);
+            workers.emplace_back(body, lo, hi);
+        }
+        body(0, (int)((long long)count / chunks));
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+    
+    // Map an offset in the circle of `size` people left back to an original
+    // position among n by running J(t) = (J(t-1) + m) mod t forward from
+    // t = size. While pos + m stays below the new circle size no wrap
+    // happens, so a whole run of those steps is taken at once; O(1) memory.
+    static long long liftPosition(long long pos, long long size, long long n, long long m) {
+        if (m == 1) {
+            return n - size + pos;
+        }
+        long long i = size;
+        while (i < n) {
+            // Steps j = 1..k keep pos + j*m < i + j, i.e. pos + j*(m-1) < i
+            long long k = std::min((i - 1 - pos) / (m - 1), n - i);
+            if (k > 0) {
+                pos += k * m;
+                i += k;
+            } else {
+                i++;
+                pos = (pos + m) % i;
+            }
+        }
+        return pos;
     }
 };
 
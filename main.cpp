@@ -2,11 +2,19 @@
 #include <iomanip>
 #include <fstream>
 #include <vector>
+#include <string>
 #include <chrono>
 #include <cmath>
+#include <numeric>
+#include <cstdio>
 #include "ost.h"
 #include "pom.h"
+#include "pom_persistent.h"
+#include "snapshot.h"
 #include "josephus.h"
+#include "ost_compact.h"
+#include "ost_frozen.h"
+#include "bench.h"
 
 using namespace std;
 
@@ -28,6 +36,28 @@ void printSubHeader(const string& subtitle) {
     cout << C_BOLD << C_YELLOW << ">>> " << subtitle << C_RESET << "\n";
 }
 
+// FindPOM is O(1), far below timer resolution for a single call: time
+// batches of queries through the bench.h harness, in μs per query
+double timeFindPOM(POMTree& pom) {
+    const int queries = 1000;
+    bench::Stats stats = bench::run(bench::Config(1, 5), queries, [&](bench::Timer& t) {
+        t.start();
+        for (int i = 0; i < queries; i++) {
+            bench::doNotOptimize(pom.findPOM());
+        }
+        t.stop();
+    });
+    return stats.median / 1000.0;
+}
+
+#ifdef TREE_STATS
+// Hot-path counters collected during one row of a benchmark (make stats)
+void printTreeStats(const string& label, const TreeStats& stats) {
+    cout << "  " << label << "\n";
+    stats.print(cout, "    ");
+}
+#endif
+
 // Test 1: Basic OST Functionality
 void testOSTBasic() {
     printHeader("TEST 1: ORDER STATISTIC TREE - BASIC OPERATIONS");
@@ -52,6 +82,120 @@ void testOSTBasic() {
     for (int val : testData) {
         cout << "  Rank of " << val << ": " << ost.rank(val) << "\n";
     }
+    cout << "  Lower-bound rank of absent 13 (rankOf): " << ost.rankOf(13) << "\n";
+    
+    cout << "\n";
+    printSubHeader("In-order iteration, lower_bound and selectRange:");
+    {
+        vector<int> walked(ost.begin(), ost.end());
+        vector<int> backward;
+        for (auto it = ost.end(); it != ost.begin();) {
+            backward.push_back(*--it);
+        }
+        cout << "  Iterated:";
+        for (int key : walked) cout << " " << key;
+        auto it = ost.lower_bound(13);
+        cout << "\n  lower_bound(13) = " << *it << ", next " << *std::next(it) << "\n";
+        vector<int> middle = ost.selectRange(2, 5);
+        cout << "  selectRange(2, 5):";
+        for (int key : middle) cout << " " << key;
+        cout << "\n";
+        bool ok = (int)walked.size() == ost.size() && middle.size() == 3 && *it == 15;
+        for (int k = 1; ok && k <= ost.size(); k++) {
+            ok = walked[k - 1] == ost.select(k) && backward[ost.size() - k] == ost.select(k);
+        }
+        for (int k = 2; ok && k < 5; k++) {
+            ok = middle[k - 2] == ost.select(k);
+        }
+        cout << "  " << (ok ? C_GREEN + "✓ Iteration matches select"
+                            : C_RED + "✗ Iteration does not match select") << C_RESET << "\n";
+    }
+    
+    cout << "\n";
+    printSubHeader("Batched queries (selectMany, rankMany, rankOfMany):");
+    {
+        vector<int> ranks = {4, 7, 1};
+        vector<int> keys = {16, 13, 8};
+        vector<int> picked = ost.selectMany(ranks);
+        vector<int> exact = ost.rankMany(keys);
+        vector<int> lower = ost.rankOfMany(keys);
+        cout << "  selectMany({4, 7, 1}):";
+        for (int key : picked) cout << " " << key;
+        cout << "\n  rankMany({16, 13, 8}):";
+        for (int r : exact) cout << " " << r;
+        cout << "\n  rankOfMany({16, 13, 8}):";
+        for (int r : lower) cout << " " << r;
+        cout << "\n";
+        bool ok = true;
+        for (size_t i = 0; i < ranks.size(); i++) {
+            ok = ok && picked[i] == ost.select(ranks[i]) && exact[i] == ost.rank(keys[i]) &&
+                 lower[i] == ost.rankOf(keys[i]);
+        }
+        cout << "  " << (ok ? C_GREEN + "✓ Batches match single queries"
+                            : C_RED + "✗ Batches do not match single queries") << C_RESET << "\n";
+    }
+    
+    cout << "\n";
+    printSubHeader("Snapshot round trip (write, mmap, query, toTree):");
+    const string path = "results/ost_demo.snap";
+    OSTSnapshot<int>::write(path, ost);
+    {
+        OSTSnapshot<int> snap(path);
+        bool same = (snap.size() == ost.size());
+        for (int k = 1; same && k <= ost.size(); k++) {
+            same = (snap.select(k) == ost.select(k));
+        }
+        for (int val : testData) {
+            same = same && snap.rank(val) == ost.rank(val);
+        }
+        same = same && snap.rankOf(13) == ost.rankOf(13);
+        OrderStatisticTree<int> restored = snap.toTree();
+        for (int k = 1; same && k <= ost.size(); k++) {
+            same = (restored.select(k) == ost.select(k));
+        }
+        cout << "  " << (same ? C_GREEN + "✓ Mapped snapshot matches the tree"
+                              : C_RED + "✗ Mapped snapshot does not match the tree") << C_RESET << "\n";
+    }
+    std::remove(path.c_str());
+    
+    cout << "\n";
+    printSubHeader("Same core with a sum monoid (weight = key / 2):");
+    {
+        AugmentedRBTree<int, long long, SumMonoid<long long>> weighted;
+        for (int val : testData) {
+            weighted.insert(val, val / 2);
+        }
+        long long expected = 0;
+        for (int val : testData) {
+            if (val >= 10 && val < 20) expected += val / 2;
+        }
+        long long got = weighted.fold(10, 20);
+        cout << "  Weight of keys in [10, 20): " << got << ", total " << weighted.summary()
+             << ", 3rd smallest key " << weighted.select(3) << "\n";
+        cout << "  " << (got == expected ? C_GREEN + "✓ Fold matches a direct sum"
+                                         : C_RED + "✗ Fold does not match a direct sum") << C_RESET << "\n";
+    }
+    
+    cout << "\n";
+    printSubHeader("String keys with a transparent comparator (std::less<>):");
+    {
+        OrderStatisticTree<std::string, int, std::less<>> names;
+        for (const char* name : {"pear", "fig", "apple", "plum", "kiwi"}) {
+            names.emplace(name);
+        }
+        names.insert(std::string("date"));
+        names.remove("plum");
+        int r = names.rank("kiwi");
+        cout << "  Keys in order:";
+        for (int k = 1; k <= names.size(); k++) {
+            cout << " " << names.select(k);
+        }
+        cout << "\n  rank(\"kiwi\") = " << r << ", contains(\"plum\") = "
+             << (names.contains("plum") ? "true" : "false") << "\n";
+        bool ok = (r == 4 && !names.contains("plum") && names.select(1) == "apple");
+        cout << "  " << (ok ? C_GREEN + "✓ Lookups by const char* match"
+                            : C_RED + "✗ Lookups by const char* do not match") << C_RESET << "\n";
+    }
     
     cout << "\n" << C_GREEN << "✓ Basic OST operations completed successfully" << C_RESET << "\n";
 }
@@ -82,6 +226,113 @@ void testPOMBasic() {
     cout << "  Max Prefix Sum: " << result.maxpref << "\n";
     cout << "  Position (argmax): " << result.argmax << "\n";
     
+    cout << "\n";
+    printSubHeader("Range query over starts in [5, 20):");
+    AugmentedData window = pom.findPOM(5, 20);
+    cout << "  Window Sum: " << window.sum << "\n";
+    cout << "  Window Max Prefix Sum: " << window.maxpref << "\n";
+    cout << "  Window Position (argmax): " << window.argmax << "\n";
+    cout << "  Prefix sum up to start 10: " << pom.prefixSumAt(10) << "\n";
+    
+    cout << "\n";
+    printSubHeader("Persistent versions (one per insert):");
+    vector<PersistentPOMTree> versions(1);
+    for (const auto& iv : intervals) {
+        versions.push_back(versions.back().insert(iv));
+    }
+    for (size_t v = 1; v < versions.size(); v++) {
+        AugmentedData past = versions[v].findPOM();
+        cout << "  Version " << v << ": " << versions[v].size() << " intervals, max prefix "
+             << past.maxpref << " at " << past.argmax << "\n";
+    }
+    
+    cout << "\n";
+    printSubHeader("Snapshot round trip (write, mmap, query, toTree):");
+    const string path = "results/pom_demo.snap";
+    POMSnapshot::write(path, pom);
+    {
+        POMSnapshot snap(path);
+        POMTree restored = snap.toTree();
+        bool same = (snap.size() == pom.size() && restored.size() == pom.size());
+        for (int a = 0; a <= 25; a += 5) {
+            for (int b = a; b <= 25; b += 5) {
+                AugmentedData want = pom.findPOM(a, b);
+                AugmentedData got = snap.findPOM(a, b);
+                AugmentedData back = restored.findPOM(a, b);
+                same = same && got.sum == want.sum && got.maxpref == want.maxpref &&
+                       got.argmax == want.argmax && back.maxpref == want.maxpref &&
+                       back.argmax == want.argmax;
+            }
+            same = same && snap.prefixSumAt(a) == pom.prefixSumAt(a);
+        }
+        same = same && snap.findPOM().maxpref == result.maxpref && snap.findPOM().argmax == result.argmax;
+        cout << "  Snapshot max prefix sum: " << snap.findPOM().maxpref << " at "
+             << snap.findPOM().argmax << "\n";
+        cout << "  " << (same ? C_GREEN + "✓ Mapped snapshot matches the tree"
+                              : C_RED + "✗ Mapped snapshot does not match the tree") << C_RESET << "\n";
+    }
+    std::remove(path.c_str());
+    
+    cout << "\n";
+    printSubHeader("Range add of +6 over starts in [5, 15):");
+    POMTree shifted;
+    POMTree rebuilt;
+    for (Interval iv : intervals) {
+        shifted.insert(iv);
+        if (iv.start >= 5 && iv.start < 15) iv.value += 6;
+        rebuilt.insert(iv);
+    }
+    shifted.addRange(5, 15, 6);
+    bool sameShift = true;
+    for (int a = 0; a <= 25; a += 5) {
+        for (int b = a; b <= 25; b += 5) {
+            AugmentedData want = rebuilt.findPOM(a, b);
+            AugmentedData got = shifted.findPOM(a, b);
+            sameShift = sameShift && got.sum == want.sum && got.maxpref == want.maxpref &&
+                        got.argmax == want.argmax;
+        }
+    }
+    AugmentedData afterShift = shifted.findPOM();
+    cout << "  Max Prefix Sum: " << afterShift.maxpref << " at " << afterShift.argmax << "\n";
+    cout << "  " << (sameShift ? C_GREEN + "✓ Range add matches rebuilding with shifted values"
+                               : C_RED + "✗ Range add does not match rebuilding with shifted values")
+         << C_RESET << "\n";
+    
+    cout << "\n";
+    printSubHeader("Maximum subarray (POMSubarrayTree), then removing [10, 15):");
+    POMSubarrayTree runs;
+    for (const auto& iv : intervals) {
+        runs.insert(iv);
+    }
+    runs.insert(Interval(20, 25, 7));
+    SubarrayData best = runs.findPOM();
+    cout << "  Max suffix sum: " << best.maxsuf << " from " << best.sufStart << "\n";
+    cout << "  Max subarray sum: " << best.maxsub << " over starts " << best.subStart
+         << ".." << best.subEnd << "\n";
+    runs.remove(Interval(10, 15, 8));
+    SubarrayData after = runs.findPOM();
+    cout << "  After removal: " << after.maxsub << " over starts " << after.subStart
+         << ".." << after.subEnd << "\n";
+    // 10 -5 8 -3 7 has best run 10..20 (17); without 8 it is the lone 10
+    bool sameRuns = best.maxsub == 17 && best.subStart == 0 && best.subEnd == 20 &&
+                    best.maxsuf == 17 && after.maxsub == 10 && after.subStart == 0 && after.subEnd == 0;
+    cout << "  " << (sameRuns ? C_GREEN + "✓ Best runs match a direct scan"
+                              : C_RED + "✗ Best runs do not match a direct scan") << C_RESET << "\n";
+    
+    cout << "\n";
+    printSubHeader("Emplace into an indexed POMTree, then remove:");
+    {
+        POMTree indexed;
+        indexed.enableIndex();
+        POMHandle handle = indexed.emplace(1, 5, 1);
+        indexed.emplace(8, 9, 2);
+        indexed.remove(Interval(1, 5, 1));
+        bool ok = handle.valid() && indexed.size() == 1 && indexed.select(1).start == 8;
+        cout << "  Size after removing [1, 5): " << indexed.size() << "\n";
+        cout << "  " << (ok ? C_GREEN + "✓ Emplaced intervals are found through the index"
+                            : C_RED + "✗ Emplaced intervals are missing from the index") << C_RESET << "\n";
+    }
+    
     cout << "\n" << C_GREEN << "✓ Basic POM operations completed successfully" << C_RESET << "\n";
 }
 
@@ -104,7 +355,7 @@ void testJosephusCorrectness() {
         bool correct = JosephusPermutation::verify(n, m);
         
         if (correct) {
-            cout << "  " << C_GREEN << "✓ OST and Naive algorithms produce identical results" << C_RESET << "\n";
+            cout << "  " << C_GREEN << "✓ OST, Fenwick, Naive, adaptive and survivor queries agree" << C_RESET << "\n";
             
             // Show first few eliminations
             vector<int> result = JosephusPermutation::generateOST(n, m);
@@ -114,7 +365,10 @@ void testJosephusCorrectness() {
                 if (i < min(10, (int)result.size()) - 1) cout << " → ";
             }
             if (result.size() > 10) cout << " ...";
-            cout << "\n\n";
+            cout << "\n";
+            cout << "  Survivor: " << JosephusPermutation::survivor(n, m)
+                 << " (person 0 eliminated at step "
+                 << JosephusPermutation::eliminationRank(n, m, 0) << ")\n\n";
         } else {
             cout << "  " << C_RED << "✗ Results do not match!" << C_RESET << "\n\n";
             allPassed = false;
@@ -133,26 +387,42 @@ void testOSTPerformance() {
     printSubHeader("Measuring operation times for increasing n");
     cout << setw(10) << "n" 
          << setw(15) << "Insert (μs)" 
+         << setw(15) << "Build (μs)" 
          << setw(15) << "Select (μs)" 
          << setw(15) << "Delete (μs)" << "\n";
-    cout << string(55, '-') << "\n";
+    cout << string(70, '-') << "\n";
     
     ofstream outfile("results/ost_performance.csv");
-    outfile << "n,insert_time,select_time,delete_time\n";
+    outfile << "n,insert_time,build_time,select_time,delete_time\n";
     
     vector<int> sizes = {100, 500, 1000, 5000, 10000, 50000, 100000};
     
     for (int n : sizes) {
-        OrderStatisticTree<int> ost;
-        
-        // Measure insert time
+        // Measure insert time (one insert per element)
+#ifdef TREE_STATS
+        TreeStats ostStats;
+#endif
         auto start = chrono::high_resolution_clock::now();
-        for (int i = 0; i < n; i++) {
-            ost.insert(i);
+        {
+            OrderStatisticTree<int> inserted;
+            for (int i = 0; i < n; i++) {
+                inserted.insert(i);
+            }
+#ifdef TREE_STATS
+            ostStats += inserted.stats();
+#endif
         }
         auto end = chrono::high_resolution_clock::now();
         long long insertTime = chrono::duration_cast<chrono::microseconds>(end - start).count();
         
+        // Measure bulk build time (initial load for the remaining tests)
+        vector<int> keys(n);
+        iota(keys.begin(), keys.end(), 0);
+        start = chrono::high_resolution_clock::now();
+        OrderStatisticTree<int> ost(keys.begin(), keys.end());
+        end = chrono::high_resolution_clock::now();
+        long long buildTime = chrono::duration_cast<chrono::microseconds>(end - start).count();
+        
         // Measure select time (average of n/2 random selections)
         start = chrono::high_resolution_clock::now();
         for (int i = 1; i <= n/2; i++) {
@@ -171,10 +441,16 @@ void testOSTPerformance() {
         
         cout << setw(10) << n 
              << setw(15) << insertTime 
+             << setw(15) << buildTime 
              << setw(15) << selectTime 
              << setw(15) << deleteTime << "\n";
+#ifdef TREE_STATS
+        ostStats += ost.stats();
+        printTreeStats("OST counters at n = " + to_string(n), ostStats);
+#endif
         
-        outfile << n << "," << insertTime << "," << selectTime << "," << deleteTime << "\n";
+        outfile << n << "," << insertTime << "," << buildTime << "," 
+                << selectTime << "," << deleteTime << "\n";
     }
     
     outfile.close();
@@ -189,12 +465,13 @@ void testJosephusPerformance() {
     cout << setw(10) << "n" 
          << setw(12) << "m"
          << setw(15) << "OST (μs)" 
+         << setw(15) << "Fenwick (μs)" 
          << setw(15) << "Naive (μs)" 
          << setw(15) << "Speedup" << "\n";
-    cout << string(67, '-') << "\n";
+    cout << string(82, '-') << "\n";
     
     ofstream outfile("results/josephus_comparison.csv");
-    outfile << "n,m,ost_time,naive_time,speedup\n";
+    outfile << "n,m,ost_time,fenwick_time,naive_time,speedup\n";
     
     vector<pair<int, int>> testCases = {
         {100, 3}, {500, 3}, {1000, 3}, {5000, 3}, {10000, 3},
@@ -203,16 +480,19 @@ void testJosephusPerformance() {
     
     for (const auto& [n, m] : testCases) {
         long long ostTime = JosephusPermutation::benchmarkOST(n, m);
+        long long fenwickTime = JosephusPermutation::benchmarkFenwick(n, m);
         long long naiveTime = JosephusPermutation::benchmarkNaive(n, m);
         double speedup = (double)naiveTime / ostTime;
         
         cout << setw(10) << n 
              << setw(12) << m
              << setw(15) << ostTime 
+             << setw(15) << fenwickTime 
              << setw(15) << naiveTime 
              << setw(14) << fixed << setprecision(2) << speedup << "x" << "\n";
         
-        outfile << n << "," << m << "," << ostTime << "," << naiveTime << "," << speedup << "\n";
+        outfile << n << "," << m << "," << ostTime << "," << fenwickTime << "," 
+                << naiveTime << "," << speedup << "\n";
     }
     
     outfile.close();
@@ -246,13 +526,8 @@ void testPOMPerformance() {
         auto end = chrono::high_resolution_clock::now();
         long long insertTime = chrono::duration_cast<chrono::microseconds>(end - start).count();
         
-        // Measure findPOM time (average of 100 queries)
-        start = chrono::high_resolution_clock::now();
-        for (int i = 0; i < 100; i++) {
-            pom.findPOM();
-        }
-        end = chrono::high_resolution_clock::now();
-        long long findTime = chrono::duration_cast<chrono::microseconds>(end - start).count() / 100;
+        // Measure findPOM time (per query, median of repeated batches)
+        double findTime = timeFindPOM(pom);
         
         // Measure delete time
         start = chrono::high_resolution_clock::now();
@@ -264,14 +539,72 @@ void testPOMPerformance() {
         
         cout << setw(12) << n 
              << setw(15) << insertTime 
-             << setw(15) << findTime 
+             << setw(15) << fixed << setprecision(5) << findTime 
              << setw(15) << deleteTime << "\n";
+#ifdef TREE_STATS
+        printTreeStats("POM counters at " + to_string(n) + " intervals", pom.stats());
+#endif
         
         outfile << n << "," << insertTime << "," << findTime << "," << deleteTime << "\n";
     }
     
     outfile.close();
     cout << "\n" << C_GREEN << "✓ Performance data saved to results/pom_performance.csv" << C_RESET << "\n";
+    
+    // Compare augmented-data update modes on the same workload
+    cout << "\n";
+    printSubHeader("Insert/delete times by update mode (full path vs incremental)");
+    cout << setw(12) << "Intervals" 
+         << setw(18) << "Full Ins (μs)" 
+         << setw(18) << "Incr Ins (μs)" 
+         << setw(18) << "Full Del (μs)" 
+         << setw(18) << "Incr Del (μs)" << "\n";
+    cout << string(84, '-') << "\n";
+    
+    ofstream modefile("results/pom_update_modes.csv");
+    modefile << "intervals,full_insert_time,incremental_insert_time,full_delete_time,incremental_delete_time\n";
+    
+    for (int n : sizes) {
+        // Scattered starts and mixed-sign values exercise both fixups
+        vector<Interval> workload;
+        for (int i = 0; i < n; i++) {
+            int start = (int)(((long long)i * 7919) % n) * 10;
+            workload.push_back(Interval(start, start + 10, ((i * 17) % 20) - 10));
+        }
+        
+        long long insertTimes[2], deleteTimes[2];
+        POMUpdateMode modes[2] = {POM_FULL_PATH, POM_INCREMENTAL};
+        
+        for (int k = 0; k < 2; k++) {
+            POMTree pom(modes[k]);
+            
+            auto start = chrono::high_resolution_clock::now();
+            for (const auto& iv : workload) {
+                pom.insert(iv);
+            }
+            auto end = chrono::high_resolution_clock::now();
+            insertTimes[k] = chrono::duration_cast<chrono::microseconds>(end - start).count();
+            
+            start = chrono::high_resolution_clock::now();
+            for (const auto& iv : workload) {
+                pom.remove(iv);
+            }
+            end = chrono::high_resolution_clock::now();
+            deleteTimes[k] = chrono::duration_cast<chrono::microseconds>(end - start).count();
+        }
+        
+        cout << setw(12) << n 
+             << setw(18) << insertTimes[0] 
+             << setw(18) << insertTimes[1] 
+             << setw(18) << deleteTimes[0] 
+             << setw(18) << deleteTimes[1] << "\n";
+        
+        modefile << n << "," << insertTimes[0] << "," << insertTimes[1] << "," 
+                 << deleteTimes[0] << "," << deleteTimes[1] << "\n";
+    }
+    
+    modefile.close();
+    cout << "\n" << C_GREEN << "✓ Update mode data saved to results/pom_update_modes.csv" << C_RESET << "\n";
 }
 
 // Test 7: Ablation Study - Impact of m on Josephus
@@ -281,27 +614,31 @@ void ablationStudyM() {
     printSubHeader("Fixed n=10000, varying m from 2 to 100");
     cout << setw(10) << "m" 
          << setw(15) << "OST (μs)" 
+         << setw(15) << "Fenwick (μs)" 
          << setw(15) << "Naive (μs)" 
          << setw(15) << "Speedup" << "\n";
-    cout << string(55, '-') << "\n";
+    cout << string(70, '-') << "\n";
     
     ofstream outfile("results/ablation_m.csv");
-    outfile << "m,ost_time,naive_time,speedup\n";
+    outfile << "m,ost_time,fenwick_time,naive_time,speedup\n";
     
     int n = 10000;
     vector<int> mValues = {2, 3, 5, 10, 20, 50, 100};
     
     for (int m : mValues) {
         long long ostTime = JosephusPermutation::benchmarkOST(n, m);
+        long long fenwickTime = JosephusPermutation::benchmarkFenwick(n, m);
         long long naiveTime = JosephusPermutation::benchmarkNaive(n, m);
         double speedup = (double)naiveTime / ostTime;
         
         cout << setw(10) << m 
              << setw(15) << ostTime 
+             << setw(15) << fenwickTime 
              << setw(15) << naiveTime 
              << setw(14) << fixed << setprecision(2) << speedup << "x" << "\n";
         
-        outfile << m << "," << ostTime << "," << naiveTime << "," << speedup << "\n";
+        outfile << m << "," << ostTime << "," << fenwickTime << "," 
+                << naiveTime << "," << speedup << "\n";
     }
     
     outfile.close();
@@ -316,40 +653,64 @@ void ablationStudyTreeDepth() {
     cout << setw(10) << "n" 
          << setw(15) << "log2(n)" 
          << setw(18) << "Avg Select (μs)" 
-         << setw(15) << "Time/log(n)" << "\n";
-    cout << string(58, '-') << "\n";
+         << setw(15) << "Time/log(n)" 
+         << setw(20) << "Compact Sel (μs)"
+         << setw(19) << "Frozen Sel (μs)" << "\n";
+    cout << string(97, '-') << "\n";
     
     ofstream outfile("results/ablation_depth.csv");
-    outfile << "n,log2n,avg_select_time,time_per_logn\n";
+    outfile << "n,log2n,avg_select_time,time_per_logn,compact_select_time,frozen_select_time\n";
     
     vector<int> sizes = {100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000};
     
     for (int n : sizes) {
         OrderStatisticTree<int> ost;
+        CompactOrderStatisticTree<int> compact;
         
         // Insert elements
         for (int i = 0; i < n; i++) {
             ost.insert(i);
+            compact.insert(i);
         }
         
         // Measure average select time
         auto start = chrono::high_resolution_clock::now();
         for (int i = 1; i <= min(1000, n); i++) {
-            ost.select((i * 17) % n + 1); // Pseudo-random positions
+            bench::doNotOptimize(ost.select((i * 17) % n + 1)); // Pseudo-random positions
         }
         auto end = chrono::high_resolution_clock::now();
         long long totalTime = chrono::duration_cast<chrono::microseconds>(end - start).count();
         double avgTime = (double)totalTime / min(1000, n);
         
+        // Same positions on the index-based compact layout
+        start = chrono::high_resolution_clock::now();
+        for (int i = 1; i <= min(1000, n); i++) {
+            bench::doNotOptimize(compact.select((i * 17) % n + 1));
+        }
+        end = chrono::high_resolution_clock::now();
+        double compactAvgTime = (double)chrono::duration_cast<chrono::microseconds>(end - start).count() / min(1000, n);
+        
+        // And on the frozen Eytzinger copy (pointer-free, read-only)
+        FrozenOrderStatisticTree<int> frozen = freeze(ost);
+        start = chrono::high_resolution_clock::now();
+        for (int i = 1; i <= min(1000, n); i++) {
+            bench::doNotOptimize(frozen.select((i * 17) % n + 1));
+        }
+        end = chrono::high_resolution_clock::now();
+        double frozenAvgTime = (double)chrono::duration_cast<chrono::nanoseconds>(end - start).count() / 1000.0 / min(1000, n);
+        
         double log2n = log2(n);
         double timePerLog = avgTime / log2n;
         
         cout << setw(10) << n 
              << setw(15) << fixed << setprecision(2) << log2n 
              << setw(18) << setprecision(4) << avgTime 
-             << setw(15) << setprecision(4) << timePerLog << "\n";
+             << setw(15) << setprecision(4) << timePerLog 
+             << setw(20) << setprecision(4) << compactAvgTime
+             << setw(19) << setprecision(4) << frozenAvgTime << "\n";
         
-        outfile << n << "," << log2n << "," << avgTime << "," << timePerLog << "\n";
+        outfile << n << "," << log2n << "," << avgTime << "," << timePerLog << "," 
+                << compactAvgTime << "," << frozenAvgTime << "\n";
     }
     
     outfile.close();
@@ -382,15 +743,12 @@ void ablationStudyPOMPatterns() {
         auto end = chrono::high_resolution_clock::now();
         long long insertTime = chrono::duration_cast<chrono::microseconds>(end - start).count();
         
-        start = chrono::high_resolution_clock::now();
-        pom.findPOM();
-        end = chrono::high_resolution_clock::now();
-        long long findTime = chrono::duration_cast<chrono::microseconds>(end - start).count();
+        double findTime = timeFindPOM(pom);
         
         cout << setw(20) << "All Positive" 
              << setw(12) << n 
              << setw(15) << insertTime 
-             << setw(15) << findTime << "\n";
+             << setw(15) << fixed << setprecision(5) << findTime << "\n";
         
         outfile << "all_positive," << n << "," << insertTime << "," << findTime << "\n";
     }
@@ -405,15 +763,12 @@ void ablationStudyPOMPatterns() {
         auto end = chrono::high_resolution_clock::now();
         long long insertTime = chrono::duration_cast<chrono::microseconds>(end - start).count();
         
-        start = chrono::high_resolution_clock::now();
-        pom.findPOM();
-        end = chrono::high_resolution_clock::now();
-        long long findTime = chrono::duration_cast<chrono::microseconds>(end - start).count();
+        double findTime = timeFindPOM(pom);
         
         cout << setw(20) << "Alternating" 
              << setw(12) << n 
              << setw(15) << insertTime 
-             << setw(15) << findTime << "\n";
+             << setw(15) << fixed << setprecision(5) << findTime << "\n";
         
         outfile << "alternating," << n << "," << insertTime << "," << findTime << "\n";
     }
@@ -429,15 +784,12 @@ void ablationStudyPOMPatterns() {
         auto end = chrono::high_resolution_clock::now();
         long long insertTime = chrono::duration_cast<chrono::microseconds>(end - start).count();
         
-        start = chrono::high_resolution_clock::now();
-        pom.findPOM();
-        end = chrono::high_resolution_clock::now();
-        long long findTime = chrono::duration_cast<chrono::microseconds>(end - start).count();
+        double findTime = timeFindPOM(pom);
         
         cout << setw(20) << "Random-like" 
              << setw(12) << n 
              << setw(15) << insertTime 
-             << setw(15) << findTime << "\n";
+             << setw(15) << fixed << setprecision(5) << findTime << "\n";
         
         outfile << "random_like," << n << "," << insertTime << "," << findTime << "\n";
     }
@@ -482,6 +834,7 @@ int main() {
     cout << "  • ost_performance.csv - OST operation benchmarks\n";
     cout << "  • josephus_comparison.csv - OST vs Naive comparison\n";
     cout << "  • pom_performance.csv - POM tree benchmarks\n";
+    cout << "  • pom_update_modes.csv - POM update mode comparison\n";
     cout << "  • ablation_m.csv - Impact of parameter m\n";
     cout << "  • ablation_depth.csv - Tree depth analysis\n";
     cout << "  • ablation_pom_patterns.csv - POM value pattern analysis\n\n";
@@ -0,0 +1,95 @@
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ * Node Pool (slab allocator)
+ * Carves fixed-size tree nodes out of large contiguous blocks
+ * - create/destroy: O(1), destroyed nodes go on a free list for reuse
+ * - release: frees every block in O(#blocks) without touching nodes
+ *
+ * Blocks start small and double in size up to MaxBlockNodes, so tiny
+ * trees stay cheap while large trees get long runs of adjacent nodes.
+ */
+
+template<typename Node, std::size_t MaxBlockNodes = 4096>
+class NodePool {
+private:
+    union Slot {
+        Slot* next;
+        alignas(Node) unsigned char storage[sizeof(Node)];
+    };
+
+    std::vector<Slot*> blocks;
+    Slot* freeList;
+    Slot* cursor;        // Next unused slot in the newest block
+    Slot* blockEnd;
+    std::size_t nextBlockNodes;
+
+    void grow() {
+        Slot* block = static_cast<Slot*>(::operator new(nextBlockNodes * sizeof(Slot)));
+        blocks.push_back(block);
+        cursor = block;
+        blockEnd = block + nextBlockNodes;
+        if (nextBlockNodes < MaxBlockNodes) {
+            nextBlockNodes *= 2;
+        }
+    }
+
+    void* allocate() {
+        if (freeList != nullptr) {
+            Slot* slot = freeList;
+            freeList = slot->next;
+            return slot;
+        }
+        if (cursor == blockEnd) {
+            grow();
+        }
+        return cursor++;
+    }
+
+public:
+    NodePool() : freeList(nullptr), cursor(nullptr), blockEnd(nullptr),
+                 nextBlockNodes(64) {}
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    ~NodePool() {
+        release();
+    }
+
+    template<typename... Args>
+    Node* create(Args&&... args) {
+        void* p = allocate();
+        return new (p) Node(std::forward<Args>(args)...);
+    }
+
+    void destroy(Node* node) {
+        node->~Node();
+        Slot* slot = reinterpret_cast<Slot*>(node);
+        slot->next = freeList;
+        freeList = slot;
+    }
+
+    // Free all blocks at once. Node destructors are NOT run; callers
+    // holding non-trivial nodes must destroy them first.
+    void release() {
+        for (Slot* block : blocks) {
+            ::operator delete(block);
+        }
+        blocks.clear();
+        freeList = cursor = blockEnd = nullptr;
+        nextBlockNodes = 64;
+    }
+
+    std::size_t blockCount() const {
+        return blocks.size();
+    }
+};
+
+#endif // NODE_POOL_H
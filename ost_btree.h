@@ -0,0 +1,537 @@
+#ifndef OST_BTREE_H
+#define OST_BTREE_H
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "node_pool.h"
+#include "simd.h"
+
+/**
+ * B+-tree Order Statistic Tree
+ * Same insert/remove/select/rank/rankOf/size API as OrderStatisticTree,
+ * stored in wide nodes instead of a binary red-black tree:
+ * - leaves hold up to LeafCapacity sorted keys and are chained left to
+ *   right; inner nodes hold up to Fanout children with the subtree count
+ *   of every child, so select runs one SIMD prefix scan per level
+ * - height is about log_{Fanout/2..Fanout}(n): 3 levels cover ~1M keys
+ *   with the defaults, versus ~20 pointer hops for the binary tree
+ * - bulk build from sorted input in O(n), plus eraseAt(k) which removes
+ *   the k-th key in a single descent
+ *
+ * Separator i of an inner node bounds child i from above and child i + 1
+ * from below (max(child i) <= seps[i] <= min(child i + 1)). Deletions only
+ * loosen that bound, so separators are never rewritten after a remove.
+ * Nodes come from NodePool slabs, one pool per node kind. T must be
+ * default constructible. SizeT is the signed count/rank type, as for
+ * OrderStatisticTree; only the 32-bit default uses the SIMD rank scan.
+ */
+
+template<typename T, int Fanout = 32, int LeafCapacity = 64, typename SizeT = int>
+class BTreeOrderStatisticTree {
+    static_assert(Fanout >= 4, "Fanout must be at least 4");
+    static_assert(LeafCapacity >= 4, "LeafCapacity must be at least 4");
+    static_assert(std::is_signed<SizeT>::value, "SizeT must be signed (rank returns -1)");
+
+private:
+    static constexpr int MIN_CHILDREN = Fanout / 2;
+    static constexpr int MIN_KEYS = LeafCapacity / 2;
+    
+    struct Node {
+        bool leaf;
+        int count;  // Keys in a leaf, children in an inner node
+        
+        Node(bool leaf) : leaf(leaf), count(0) {}
+    };
+    
+    struct Leaf : Node {
+        Leaf* next;
+        T keys[LeafCapacity];
+        
+        Leaf() : Node(true), next(nullptr) {}
+    };
+    
+    struct Inner : Node {
+        SizeT sizes[Fanout];     // Keys under each child
+        T seps[Fanout - 1];
+        Node* child[Fanout];
+        
+        Inner() : Node(false) {}
+    };
+    
+    NodePool<Leaf> leafPool;
+    NodePool<Inner> innerPool;
+    Node* root;
+    SizeT total;
+    
+    static SizeT nodeSize(Node* node) {
+        if (node->leaf) return node->count;
+        Inner* in = static_cast<Inner*>(node);
+        SizeT sum = 0;
+        for (int i = 0; i < in->count; i++) {
+            sum += in->sizes[i];
+        }
+        return sum;
+    }
+    
+    // First child whose separator is >= key (the last child if none)
+    static int childFor(const Inner* in, const T& key) {
+        int i = 0;
+        while (i < in->count - 1 && in->seps[i] < key) {
+            i++;
+        }
+        return i;
+    }
+    
+    // Child holding the k-th key under `in`; k becomes the rank inside it.
+    // A vector prefix scan over 32-bit child counts (see simd.h).
+    static int childForRank(const Inner* in, SizeT& k) {
+        if constexpr (std::is_same<SizeT, int>::value) {
+            return simd::rankSlot(in->sizes, in->count, k);
+        } else {
+            int i = 0;
+            while (i < in->count && k > in->sizes[i]) {
+                k -= in->sizes[i];
+                i++;
+            }
+            return i;
+        }
+    }
+    
+    static int lowerBound(const Leaf* leaf, const T& key) {
+        return (int)(std::lower_bound(leaf->keys, leaf->keys + leaf->count, key) - leaf->keys);
+    }
+    
+    static int upperBound(const Leaf* leaf, const T& key) {
+        return (int)(std::upper_bound(leaf->keys, leaf->keys + leaf->count, key) - leaf->keys);
+    }
+    
+    // Insert key under node. If node splits, return the new right sibling
+    // and set sep to the separator between the two halves.
+    Node* insertInto(Node* node, const T& key, T& sep) {
+        if (node->leaf) {
+            Leaf* leaf = static_cast<Leaf*>(node);
+            int pos = upperBound(leaf, key);
+            if (leaf->count < LeafCapacity) {
+                std::copy_backward(leaf->keys + pos, leaf->keys + leaf->count,
+                                   leaf->keys + leaf->count + 1);
+                leaf->keys[pos] = key;
+                leaf->count++;
+                return nullptr;
+            }
+            
+            Leaf* right = leafPool.create();
+            int half = (LeafCapacity + 1) / 2;
+            std::copy(leaf->keys + half, leaf->keys + LeafCapacity, right->keys);
+            right->count = LeafCapacity - half;
+            leaf->count = half;
+            right->next = leaf->next;
+            leaf->next = right;
+            
+            Leaf* target = pos <= half ? leaf : right;
+            if (target == right) pos -= half;
+            std::copy_backward(target->keys + pos, target->keys + target->count,
+                               target->keys + target->count + 1);
+            target->keys[pos] = key;
+            target->count++;
+            
+            sep = leaf->keys[leaf->count - 1];
+            return right;
+        }
+        
+        Inner* in = static_cast<Inner*>(node);
+        int i = childFor(in, key);
+        in->sizes[i]++;
+        T childSep;
+        Node* split = insertInto(in->child[i], key, childSep);
+        if (split == nullptr) return nullptr;
+        
+        SizeT splitSize = nodeSize(split);
+        in->sizes[i] -= splitSize;
+        return insertChild(in, i + 1, split, splitSize, childSep, sep);
+    }
+    
+    // Place child at index `at` with separator seps[at - 1] = childSep.
+    // A full node splits in half; the new right node is returned and the
+    // separator between the halves goes out through sep.
+    Node* insertChild(Inner* in, int at, Node* child, SizeT childSize, const T& childSep, T& sep) {
+        if (in->count < Fanout) {
+            std::copy_backward(in->child + at, in->child + in->count, in->child + in->count + 1);
+            std::copy_backward(in->sizes + at, in->sizes + in->count, in->sizes + in->count + 1);
+            std::copy_backward(in->seps + at - 1, in->seps + in->count - 1, in->seps + in->count);
+            in->child[at] = child;
+            in->sizes[at] = childSize;
+            in->seps[at - 1] = childSep;
+            in->count++;
+            return nullptr;
+        }
+        
+        // Lay out all Fanout + 1 children, then deal them to two nodes
+        Node* children[Fanout + 1];
+        SizeT sizes[Fanout + 1];
+        T seps[Fanout];
+        for (int j = 0, src = 0; j <= Fanout; j++) {
+            if (j == at) {
+                children[j] = child;
+                sizes[j] = childSize;
+            } else {
+                children[j] = in->child[src];
+                sizes[j] = in->sizes[src];
+                src++;
+            }
+        }
+        for (int j = 0, src = 0; j < Fanout; j++) {
+            seps[j] = j == at - 1 ? childSep : in->seps[src++];
+        }
+        
+        Inner* right = innerPool.create();
+        int left = (Fanout + 1) / 2;
+        in->count = left;
+        right->count = Fanout + 1 - left;
+        for (int j = 0; j < left; j++) {
+            in->child[j] = children[j];
+            in->sizes[j] = sizes[j];
+        }
+        for (int j = 0; j < right->count; j++) {
+            right->child[j] = children[left + j];
+            right->sizes[j] = sizes[left + j];
+        }
+        std::copy(seps, seps + left - 1, in->seps);
+        std::copy(seps + left, seps + Fanout, right->seps);
+        sep = seps[left - 1];
+        return right;
+    }
+    
+    // Remove the k-th key (1-indexed) under node, rebalancing on the way
+    // back up, and return it
+    T eraseFrom(Node* node, SizeT k) {
+        if (node->leaf) {
+            Leaf* leaf = static_cast<Leaf*>(node);
+            T key = leaf->keys[k - 1];
+            std::copy(leaf->keys + k, leaf->keys + leaf->count, leaf->keys + k - 1);
+            leaf->count--;
+            return key;
+        }
+        
+        Inner* in = static_cast<Inner*>(node);
+        int i = childForRank(in, k);
+        in->sizes[i]--;
+        T key = eraseFrom(in->child[i], k);
+        
+        Node* c = in->child[i];
+        if (c->count < (c->leaf ? MIN_KEYS : MIN_CHILDREN)) {
+            fixUnderflow(in, i);
+        }
+        return key;
+    }
+    
+    // Child i of `in` is below minimum occupancy: merge it with a sibling
+    // or borrow one entry from it
+    void fixUnderflow(Inner* in, int i) {
+        int a = i > 0 ? i - 1 : i;
+        int b = a + 1;
+        Node* na = in->child[a];
+        Node* nb = in->child[b];
+        int capacity = na->leaf ? LeafCapacity : Fanout;
+        
+        if (na->count + nb->count <= capacity) {
+            merge(in, a);
+        } else if (a == i) {
+            borrowFromRight(in, a);
+        } else {
+            borrowFromLeft(in, a);
+        }
+    }
+    
+    // Fold child a + 1 into child a and drop it from `in`
+    void merge(Inner* in, int a) {
+        int b = a + 1;
+        if (in->child[a]->leaf) {
+            Leaf* la = static_cast<Leaf*>(in->child[a]);
+            Leaf* lb = static_cast<Leaf*>(in->child[b]);
+            std::copy(lb->keys, lb->keys + lb->count, la->keys + la->count);
+            la->count += lb->count;
+            la->next = lb->next;
+            leafPool.destroy(lb);
+        } else {
+            Inner* ia = static_cast<Inner*>(in->child[a]);
+            Inner* ib = static_cast<Inner*>(in->child[b]);
+            ia->seps[ia->count - 1] = in->seps[a];
+            std::copy(ib->seps, ib->seps + ib->count - 1, ia->seps + ia->count);
+            std::copy(ib->child, ib->child + ib->count, ia->child + ia->count);
+            std::copy(ib->sizes, ib->sizes + ib->count, ia->sizes + ia->count);
+            ia->count += ib->count;
+            innerPool.destroy(ib);
+        }
+        
+        in->sizes[a] += in->sizes[b];
+        std::copy(in->child + b + 1, in->child + in->count, in->child + b);
+        std::copy(in->sizes + b + 1, in->sizes + in->count, in->sizes + b);
+        std::copy(in->seps + b, in->seps + in->count - 1, in->seps + a);
+        in->count--;
+    }
+    
+    // Move the first entry of child a + 1 to the end of child a
+    void borrowFromRight(Inner* in, int a) {
+        int b = a + 1;
+        SizeT moved;
+        if (in->child[a]->leaf) {
+            Leaf* la = static_cast<Leaf*>(in->child[a]);
+            Leaf* lb = static_cast<Leaf*>(in->child[b]);
+            la->keys[la->count++] = lb->keys[0];
+            std::copy(lb->keys + 1, lb->keys + lb->count, lb->keys);
+            lb->count--;
+            in->seps[a] = la->keys[la->count - 1];
+            moved = 1;
+        } else {
+            Inner* ia = static_cast<Inner*>(in->child[a]);
+            Inner* ib = static_cast<Inner*>(in->child[b]);
+            moved = ib->sizes[0];
+            ia->seps[ia->count - 1] = in->seps[a];
+            ia->child[ia->count] = ib->child[0];
+            ia->sizes[ia->count] = moved;
+            ia->count++;
+            in->seps[a] = ib->seps[0];
+            std::copy(ib->child + 1, ib->child + ib->count, ib->child);
+            std::copy(ib->sizes + 1, ib->sizes + ib->count, ib->sizes);
+            std::copy(ib->seps + 1, ib->seps + ib->count - 1, ib->seps);
+            ib->count--;
+        }
+        in->sizes[a] += moved;
+        in->sizes[b] -= moved;
+    }
+    
+    // Move the last entry of child a to the front of child a + 1
+    void borrowFromLeft(Inner* in, int a) {
+        int b = a + 1;
+        SizeT moved;
+        if (in->child[a]->leaf) {
+            Leaf* la = static_cast<Leaf*>(in->child[a]);
+            Leaf* lb = static_cast<Leaf*>(in->child[b]);
+            std::copy_backward(lb->keys, lb->keys + lb->count, lb->keys + lb->count + 1);
+            lb->keys[0] = la->keys[--la->count];
+            lb->count++;
+            in->seps[a] = la->keys[la->count - 1];
+            moved = 1;
+        } else {
+            Inner* ia = static_cast<Inner*>(in->child[a]);
+            Inner* ib = static_cast<Inner*>(in->child[b]);
+            moved = ia->sizes[ia->count - 1];
+            std::copy_backward(ib->child, ib->child + ib->count, ib->child + ib->count + 1);
+            std::copy_backward(ib->sizes, ib->sizes + ib->count, ib->sizes + ib->count + 1);
+            std::copy_backward(ib->seps, ib->seps + ib->count - 1, ib->seps + ib->count);
+            ib->child[0] = ia->child[ia->count - 1];
+            ib->sizes[0] = moved;
+            ib->seps[0] = in->seps[a];
+            ib->count++;
+            in->seps[a] = ia->seps[ia->count - 2];
+            ia->count--;
+        }
+        in->sizes[a] -= moved;
+        in->sizes[b] += moved;
+    }
+    
+    // Descend to the leaf where key's lower_bound lives; less counts the
+    // keys before that leaf
+    Leaf* findLeaf(const T& key, SizeT& less) const {
+        less = 0;
+        Node* node = root;
+        while (!node->leaf) {
+            const Inner* in = static_cast<const Inner*>(node);
+            int i = childFor(in, key);
+            for (int j = 0; j < i; j++) {
+                less += in->sizes[j];
+            }
+            node = in->child[i];
+        }
+        return static_cast<Leaf*>(node);
+    }
+    
+    void destroyNodes(Node* node) {
+        if (!node->leaf) {
+            Inner* in = static_cast<Inner*>(node);
+            for (int i = 0; i < in->count; i++) {
+                destroyNodes(in->child[i]);
+            }
+            innerPool.destroy(in);
+        } else {
+            leafPool.destroy(static_cast<Leaf*>(node));
+        }
+    }
+
+public:
+    using value_type = T;
+    using size_type = SizeT;
+    
+    BTreeOrderStatisticTree() : root(leafPool.create()), total(0) {}
+    
+    // Build from a range that is already sorted, in O(n)
+    template<typename InputIt,
+             typename = typename std::iterator_traits<InputIt>::iterator_category>
+    BTreeOrderStatisticTree(InputIt first, InputIt last) : BTreeOrderStatisticTree() {
+        buildFromSorted(first, last);
+    }
+    
+    BTreeOrderStatisticTree(const BTreeOrderStatisticTree&) = delete;
+    BTreeOrderStatisticTree& operator=(const BTreeOrderStatisticTree&) = delete;
+    
+    ~BTreeOrderStatisticTree() {
+        if (!std::is_trivially_destructible<T>::value) {
+            destroyNodes(root);
+        }
+        // Otherwise the pools free whole blocks when they go away
+    }
+    
+    void clear() {
+        if (!std::is_trivially_destructible<T>::value) {
+            destroyNodes(root);
+        }
+        leafPool.release();
+        innerPool.release();
+        root = leafPool.create();
+        total = 0;
+    }
+    
+    // Replace the contents with a sorted range in O(n). Each level is dealt
+    // out evenly so every node starts at least half full.
+    template<typename InputIt>
+    void buildFromSorted(InputIt first, InputIt last) {
+        std::vector<T> keys(first, last);
+        clear();
+        SizeT n = (SizeT)keys.size();
+        if (n == 0) return;
+        
+        std::vector<Node*> level;
+        std::vector<SizeT> sizes;
+        std::vector<T> maxKeys;
+        SizeT groups = (n + LeafCapacity - 1) / LeafCapacity;
+        Leaf* prev = nullptr;
+        for (SizeT g = 0, pos = 0; g < groups; g++) {
+            int take = (int)(n / groups + (g < n % groups ? 1 : 0));
+            Leaf* leaf = g == 0 ? static_cast<Leaf*>(root) : leafPool.create();
+            std::copy(keys.begin() + pos, keys.begin() + pos + take, leaf->keys);
+            leaf->count = take;
+            if (prev != nullptr) prev->next = leaf;
+            prev = leaf;
+            pos += take;
+            level.push_back(leaf);
+            sizes.push_back(take);
+            maxKeys.push_back(leaf->keys[take - 1]);
+        }
+        
+        while (level.size() > 1) {
+            SizeT m = (SizeT)level.size();
+            groups = (m + Fanout - 1) / Fanout;
+            std::vector<Node*> parents;
+            std::vector<SizeT> parentSizes;
+            std::vector<T> parentMax;
+            for (SizeT g = 0, pos = 0; g < groups; g++) {
+                int take = (int)(m / groups + (g < m % groups ? 1 : 0));
+                Inner* in = innerPool.create();
+                SizeT sum = 0;
+                for (int j = 0; j < take; j++) {
+                    in->child[j] = level[pos + j];
+                    in->sizes[j] = sizes[pos + j];
+                    sum += sizes[pos + j];
+                    if (j < take - 1) in->seps[j] = maxKeys[pos + j];
+                }
+                in->count = take;
+                pos += take;
+                parents.push_back(in);
+                parentSizes.push_back(sum);
+                parentMax.push_back(maxKeys[pos - 1]);
+            }
+            level.swap(parents);
+            sizes.swap(parentSizes);
+            maxKeys.swap(parentMax);
+        }
+        root = level[0];
+        total = n;
+    }
+    
+    void insert(T key) {
+        T sep;
+        Node* split = insertInto(root, key, sep);
+        total++;
+        if (split != nullptr) {
+            Inner* top = innerPool.create();
+            top->child[0] = root;
+            top->child[1] = split;
+            top->sizes[1] = nodeSize(split);
+            top->sizes[0] = total - top->sizes[1];
+            top->seps[0] = sep;
+            top->count = 2;
+            root = top;
+        }
+    }
+    
+    // Remove one copy of key if present
+    void remove(T key) {
+        SizeT r = rank(key);
+        if (r == -1) return;
+        eraseAt(r);
+    }
+    
+    // Remove and return the k-th smallest key (1-indexed) in one descent
+    T eraseAt(SizeT k) {
+        if (k < 1 || k > total) {
+            throw std::out_of_range("Index out of range");
+        }
+        T key = eraseFrom(root, k);
+        total--;
+        if (!root->leaf && root->count == 1) {
+            Inner* old = static_cast<Inner*>(root);
+            root = old->child[0];
+            innerPool.destroy(old);
+        }
+        return key;
+    }
+    
+    // Find k-th smallest element (1-indexed)
+    T select(SizeT k) const {
+        if (k < 1 || k > total) {
+            throw std::out_of_range("Index out of range");
+        }
+        const Node* node = root;
+        while (!node->leaf) {
+            const Inner* in = static_cast<const Inner*>(node);
+            node = in->child[childForRank(in, k)];
+        }
+        return static_cast<const Leaf*>(node)->keys[k - 1];
+    }
+    
+    // Find rank (position) of element (1-indexed), -1 if absent
+    SizeT rank(T key) const {
+        SizeT less;
+        const Leaf* leaf = findLeaf(key, less);
+        int pos = lowerBound(leaf, key);
+        if (pos == leaf->count) {
+            // Every key here is smaller; the candidate opens the next leaf
+            leaf = leaf->next;
+            less += pos;
+            pos = 0;
+            if (leaf == nullptr || leaf->count == 0) return -1;
+        }
+        if (key < leaf->keys[pos]) return -1;
+        return less + pos + 1;
+    }
+    
+    // 1 + number of elements < key (lower_bound). Works for absent keys.
+    SizeT rankOf(T key) const {
+        SizeT less;
+        const Leaf* leaf = findLeaf(key, less);
+        return less + lowerBound(leaf, key) + 1;
+    }
+    
+    SizeT size() const {
+        return total;
+    }
+    
+    bool empty() const {
+        return total == 0;
+    }
+};
+
+#endif // OST_BTREE_H
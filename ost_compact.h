@@ -0,0 +1,474 @@
+#ifndef OST_COMPACT_H
+#define OST_COMPACT_H
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * Compact Order Statistic Tree
+ * Same red-black algorithm and API as OrderStatisticTree, with a
+ * cache-oriented storage backend:
+ * - nodes live in contiguous vectors and link by 32-bit indices
+ *   (index 0 is the sentinel), so there is no per-node allocation
+ * - hot fields read by select (left, right, size) are packed into a
+ *   12-byte record; cold fields (key, parent) live in separate arrays
+ * - the color is stored in the top bit of the parent index
+ *
+ * A select descent touches 12 bytes per level instead of a full
+ * pointer-based node, so roughly 5 levels share one cache line's worth
+ * of the hot array. Capacity is 2^31 - 1 nodes.
+ */
+
+template<typename T>
+class CompactOrderStatisticTree {
+private:
+    static constexpr uint32_t NIL = 0;
+    static constexpr uint32_t RED_BIT = 0x80000000u;
+    
+    struct HotNode {
+        uint32_t left;
+        uint32_t right;
+        uint32_t size;  // Size of subtree rooted at this node
+    };
+    
+    std::vector<HotNode> hot;
+    std::vector<uint32_t> parentColor;  // Parent index | RED_BIT if red
+    std::vector<T> keys;
+    uint32_t root;
+    uint32_t freeList;  // Removed slots, chained through hot[i].left
+    
+    uint32_t parent(uint32_t i) const {
+        return parentColor[i] & ~RED_BIT;
+    }
+    
+    void setParent(uint32_t i, uint32_t p) {
+        parentColor[i] = (parentColor[i] & RED_BIT) | p;
+    }
+    
+    bool isRed(uint32_t i) const {
+        return (parentColor[i] & RED_BIT) != 0;
+    }
+    
+    void setRed(uint32_t i) {
+        parentColor[i] |= RED_BIT;
+    }
+    
+    void setBlack(uint32_t i) {
+        parentColor[i] &= ~RED_BIT;
+    }
+    
+    void copyColor(uint32_t to, uint32_t from) {
+        parentColor[to] = (parentColor[to] & ~RED_BIT) | (parentColor[from] & RED_BIT);
+    }
+    
+    uint32_t newNode(const T& key) {
+        uint32_t i;
+        if (freeList != NIL) {
+            i = freeList;
+            freeList = hot[i].left;
+            keys[i] = key;
+        } else {
+            if (hot.size() >= RED_BIT) {
+                throw std::length_error("CompactOrderStatisticTree capacity exceeded");
+            }
+            i = static_cast<uint32_t>(hot.size());
+            hot.push_back(HotNode());
+            parentColor.push_back(0);
+            keys.push_back(key);
+        }
+        hot[i].left = hot[i].right = NIL;
+        hot[i].size = 1;
+        parentColor[i] = RED_BIT | NIL;
+        return i;
+    }
+    
+    void freeNode(uint32_t i) {
+        hot[i].left = freeList;
+        freeList = i;
+    }
+    
+    void leftRotate(uint32_t x) {
+        uint32_t y = hot[x].right;
+        hot[x].right = hot[y].left;
+        
+        if (hot[y].left != NIL) {
+            setParent(hot[y].left, x);
+        }
+        
+        uint32_t px = parent(x);
+        setParent(y, px);
+        
+        if (px == NIL) {
+            root = y;
+        } else if (x == hot[px].left) {
+            hot[px].left = y;
+        } else {
+            hot[px].right = y;
+        }
+        
+        hot[y].left = x;
+        setParent(x, y);
+        
+        // Update sizes
+        hot[y].size = hot[x].size;
+        hot[x].size = hot[hot[x].left].size + hot[hot[x].right].size + 1;
+    }
+    
+    void rightRotate(uint32_t y) {
+        uint32_t x = hot[y].left;
+        hot[y].left = hot[x].right;
+        
+        if (hot[x].right != NIL) {
+            setParent(hot[x].right, y);
+        }
+        
+        uint32_t py = parent(y);
+        setParent(x, py);
+        
+        if (py == NIL) {
+            root = x;
+        } else if (y == hot[py].right) {
+            hot[py].right = x;
+        } else {
+            hot[py].left = x;
+        }
+        
+        hot[x].right = y;
+        setParent(y, x);
+        
+        // Update sizes
+        hot[x].size = hot[y].size;
+        hot[y].size = hot[hot[y].left].size + hot[hot[y].right].size + 1;
+    }
+    
+    void insertFixup(uint32_t z) {
+        while (isRed(parent(z))) {
+            uint32_t p = parent(z);
+            uint32_t g = parent(p);
+            if (p == hot[g].left) {
+                uint32_t y = hot[g].right;
+                if (isRed(y)) {
+                    setBlack(p);
+                    setBlack(y);
+                    setRed(g);
+                    z = g;
+                } else {
+                    if (z == hot[p].right) {
+                        z = p;
+                        leftRotate(z);
+                    }
+                    setBlack(parent(z));
+                    setRed(parent(parent(z)));
+                    rightRotate(parent(parent(z)));
+                }
+            } else {
+                uint32_t y = hot[g].left;
+                if (isRed(y)) {
+                    setBlack(p);
+                    setBlack(y);
+                    setRed(g);
+                    z = g;
+                } else {
+                    if (z == hot[p].left) {
+                        z = p;
+                        rightRotate(z);
+                    }
+                    setBlack(parent(z));
+                    setRed(parent(parent(z)));
+                    leftRotate(parent(parent(z)));
+                }
+            }
+        }
+        setBlack(root);
+    }
+    
+    void transplant(uint32_t u, uint32_t v) {
+        uint32_t pu = parent(u);
+        if (pu == NIL) {
+            root = v;
+        } else if (u == hot[pu].left) {
+            hot[pu].left = v;
+        } else {
+            hot[pu].right = v;
+        }
+        setParent(v, pu);
+    }
+    
+    uint32_t minimum(uint32_t x) const {
+        while (hot[x].left != NIL) {
+            x = hot[x].left;
+        }
+        return x;
+    }
+    
+    void deleteFixup(uint32_t x) {
+        while (x != root && !isRed(x)) {
+            uint32_t p = parent(x);
+            if (x == hot[p].left) {
+                uint32_t w = hot[p].right;
+                if (isRed(w)) {
+                    setBlack(w);
+                    setRed(p);
+                    leftRotate(p);
+                    w = hot[parent(x)].right;
+                }
+                if (!isRed(hot[w].left) && !isRed(hot[w].right)) {
+                    setRed(w);
+                    x = parent(x);
+                } else {
+                    if (!isRed(hot[w].right)) {
+                        setBlack(hot[w].left);
+                        setRed(w);
+                        rightRotate(w);
+                        w = hot[parent(x)].right;
+                    }
+                    copyColor(w, parent(x));
+                    setBlack(parent(x));
+                    setBlack(hot[w].right);
+                    leftRotate(parent(x));
+                    x = root;
+                }
+            } else {
+                uint32_t w = hot[p].left;
+                if (isRed(w)) {
+                    setBlack(w);
+                    setRed(p);
+                    rightRotate(p);
+                    w = hot[parent(x)].left;
+                }
+                if (!isRed(hot[w].right) && !isRed(hot[w].left)) {
+                    setRed(w);
+                    x = parent(x);
+                } else {
+                    if (!isRed(hot[w].left)) {
+                        setBlack(hot[w].right);
+                        setRed(w);
+                        leftRotate(w);
+                        w = hot[parent(x)].left;
+                    }
+                    copyColor(w, parent(x));
+                    setBlack(parent(x));
+                    setBlack(hot[w].left);
+                    rightRotate(parent(x));
+                    x = root;
+                }
+            }
+        }
+        setBlack(x);
+    }
+    
+    uint32_t search(T key) const {
+        uint32_t x = root;
+        while (x != NIL && key != keys[x]) {
+            if (key < keys[x]) {
+                x = hot[x].left;
+            } else {
+                x = hot[x].right;
+            }
+        }
+        return x;
+    }
+    
+    // Link slots [lo, hi) (already in key order) into a balanced subtree
+    uint32_t linkBalanced(uint32_t lo, uint32_t hi, uint32_t p, int depth, int redDepth) {
+        if (lo == hi) return NIL;
+        
+        uint32_t mid = lo + (hi - lo) / 2;
+        hot[mid].left = linkBalanced(lo, mid, mid, depth + 1, redDepth);
+        hot[mid].right = linkBalanced(mid + 1, hi, mid, depth + 1, redDepth);
+        hot[mid].size = hi - lo;
+        parentColor[mid] = p | (depth == redDepth ? RED_BIT : 0);
+        return mid;
+    }
+
+public:
+    using value_type = T;
+    using size_type = int;
+    
+    CompactOrderStatisticTree() : root(NIL), freeList(NIL) {
+        // Slot 0 is the black sentinel with size 0
+        hot.push_back(HotNode{NIL, NIL, 0});
+        parentColor.push_back(NIL);
+        keys.push_back(T());
+    }
+    
+    void reserve(std::size_t n) {
+        hot.reserve(n + 1);
+        parentColor.reserve(n + 1);
+        keys.reserve(n + 1);
+    }
+    
+    void clear() {
+        hot.resize(1);
+        parentColor.resize(1);
+        keys.resize(1);
+        root = freeList = NIL;
+    }
+    
+    // Replace the contents with a sorted range in O(n). Slots are laid out
+    // in key order, so in-order neighbours are also neighbours in memory.
+    template<typename InputIt>
+    void buildFromSorted(InputIt first, InputIt last) {
+        clear();
+        for (; first != last; ++first) {
+            if (hot.size() >= RED_BIT) {
+                throw std::length_error("CompactOrderStatisticTree capacity exceeded");
+            }
+            hot.push_back(HotNode());
+            parentColor.push_back(0);
+            keys.push_back(*first);
+        }
+        uint32_t n = static_cast<uint32_t>(hot.size() - 1);
+        int redDepth = -1;
+        if (((n + 1) & n) != 0) {
+            // Deepest level floor(log2 n) is only partially filled
+            redDepth = 0;
+            while ((n >> (redDepth + 1)) != 0) redDepth++;
+        }
+        root = linkBalanced(1, n + 1, NIL, 0, redDepth);
+        setBlack(root);
+    }
+    
+    void insert(T key) {
+        uint32_t z = newNode(key);
+        
+        uint32_t y = NIL;
+        uint32_t x = root;
+        
+        while (x != NIL) {
+            y = x;
+            hot[x].size++;  // Increment size along the path
+            if (key < keys[x]) {
+                x = hot[x].left;
+            } else {
+                x = hot[x].right;
+            }
+        }
+        
+        setParent(z, y);
+        
+        if (y == NIL) {
+            root = z;
+        } else if (key < keys[y]) {
+            hot[y].left = z;
+        } else {
+            hot[y].right = z;
+        }
+        
+        insertFixup(z);
+    }
+    
+    void remove(T key) {
+        uint32_t z = search(key);
+        if (z == NIL) return;
+        
+        // Decrement sizes along path from z to root
+        for (uint32_t p = z; p != NIL; p = parent(p)) {
+            hot[p].size--;
+        }
+        
+        uint32_t y = z;
+        uint32_t x;
+        bool yOriginalRed = isRed(y);
+        
+        if (hot[z].left == NIL) {
+            x = hot[z].right;
+            transplant(z, hot[z].right);
+        } else if (hot[z].right == NIL) {
+            x = hot[z].left;
+            transplant(z, hot[z].left);
+        } else {
+            y = minimum(hot[z].right);
+            yOriginalRed = isRed(y);
+            x = hot[y].right;
+            
+            if (parent(y) == z) {
+                setParent(x, y);
+            } else {
+                // Decrement sizes from y to z
+                for (uint32_t p = parent(y); p != z; p = parent(p)) {
+                    hot[p].size--;
+                }
+                transplant(y, hot[y].right);
+                hot[y].right = hot[z].right;
+                setParent(hot[y].right, y);
+            }
+            
+            transplant(z, y);
+            hot[y].left = hot[z].left;
+            setParent(hot[y].left, y);
+            copyColor(y, z);
+            hot[y].size = hot[hot[y].left].size + hot[hot[y].right].size + 1;
+        }
+        
+        freeNode(z);
+        
+        if (!yOriginalRed) {
+            deleteFixup(x);
+        }
+    }
+    
+    // Find k-th smallest element (1-indexed)
+    T select(int k) const {
+        uint32_t x = root;
+        uint32_t want = static_cast<uint32_t>(k);
+        if (k < 1) x = NIL;
+        while (x != NIL) {
+            uint32_t r = hot[hot[x].left].size + 1;
+            if (want == r) {
+                return keys[x];
+            } else if (want < r) {
+                x = hot[x].left;
+            } else {
+                want -= r;
+                x = hot[x].right;
+            }
+        }
+        throw std::out_of_range("Index out of range");
+    }
+    
+    // Find rank (position) of element (1-indexed), -1 if absent
+    int rank(T key) const {
+        int r = 0;
+        uint32_t x = root;
+        while (x != NIL) {
+            if (key != keys[x]) {
+                if (key < keys[x]) {
+                    x = hot[x].left;
+                } else {
+                    r += hot[hot[x].left].size + 1;
+                    x = hot[x].right;
+                }
+            } else {
+                return r + hot[hot[x].left].size + 1;
+            }
+        }
+        return -1;
+    }
+    
+    // 1 + number of elements < key (lower_bound position)
+    int rankOf(T key) const {
+        int less = 0;
+        uint32_t x = root;
+        while (x != NIL) {
+            if (keys[x] < key) {
+                less += hot[hot[x].left].size + 1;
+                x = hot[x].right;
+            } else {
+                x = hot[x].left;
+            }
+        }
+        return less + 1;
+    }
+    
+    int size() const {
+        return static_cast<int>(hot[root].size);
+    }
+    
+    bool empty() const {
+        return root == NIL;
+    }
+};
+
+#endif // OST_COMPACT_H
@@ -0,0 +1,211 @@
+#ifndef OST_CONCURRENT_H
+#define OST_CONCURRENT_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Concurrent Order Statistic Tree (RCU-style snapshots)
+ * Readers work on an immutable published snapshot and never wait for a
+ * writer; writers are serialized and batched:
+ * - a snapshot is the sorted key array, so select is one array load and
+ *   rank/rankOf are binary searches (O(1) / O(log n), no pointer chasing)
+ * - insert/remove append to a pending batch under the writer lock; when
+ *   the batch reaches batchSize (or on commit()), it is merged into a new
+ *   snapshot in O(n + k log k) and published with one pointer swap
+ * - old snapshots are reclaimed by reference count once the last reader
+ *   holding them moves on, which plays the role of an RCU grace period
+ *
+ * Reads see the state as of the last commit, so a batch becomes visible
+ * atomically. Each thread should read through its own Reader: a Reader
+ * caches the snapshot and only re-acquires it (briefly taking the publish
+ * lock) when the published version has changed, so steady-state reads
+ * touch no shared cache line except one atomic version load. The
+ * convenience reads on the tree itself take the publish lock per call.
+ *
+ * Removing a missing key is a no-op, as in OrderStatisticTree; within a
+ * batch, operations apply in the order they were issued. SizeT is the
+ * signed rank type, as for OrderStatisticTree.
+ */
+
+template<typename T, typename SizeT = int>
+class ConcurrentOrderStatisticTree {
+    static_assert(std::is_signed<SizeT>::value, "SizeT must be signed (rank returns -1)");
+
+private:
+    struct Snapshot {
+        std::vector<T> keys;
+        std::uint64_t version;
+        
+        Snapshot(std::vector<T> keys, std::uint64_t version)
+            : keys(std::move(keys)), version(version) {}
+    };
+    
+    struct PendingOp {
+        T key;
+        bool insert;
+    };
+    
+    std::shared_ptr<const Snapshot> current;    // Guarded by publishMutex
+    std::atomic<std::uint64_t> version;
+    mutable std::mutex publishMutex;
+    std::mutex writerMutex;
+    std::vector<PendingOp> pending;             // Guarded by writerMutex
+    std::size_t batchSize;
+    
+    std::shared_ptr<const Snapshot> acquire() const {
+        std::lock_guard<std::mutex> lock(publishMutex);
+        return current;
+    }
+    
+    // Merge the pending batch into a new snapshot and publish it.
+    // Caller holds writerMutex, so `current` cannot change underneath.
+    void commitLocked() {
+        if (pending.empty()) return;
+        
+        std::shared_ptr<const Snapshot> base = acquire();
+        const std::vector<T>& old = base->keys;
+        
+        // Order the batch by key; the stable sort keeps each key's
+        // operations in issue order so they can be replayed per key
+        std::stable_sort(pending.begin(), pending.end(),
+                         [](const PendingOp& a, const PendingOp& b) { return a.key < b.key; });
+        
+        std::vector<T> merged;
+        merged.reserve(old.size() + pending.size());
+        std::size_t i = 0;
+        for (std::size_t g = 0; g < pending.size(); ) {
+            const T& key = pending[g].key;
+            while (i < old.size() && old[i] < key) {
+                merged.push_back(old[i++]);
+            }
+            std::size_t present = 0;
+            while (i + present < old.size() && !(key < old[i + present])) {
+                present++;
+            }
+            
+            // Replay this key's operations against its current count
+            std::size_t count = present;
+            for (; g < pending.size() && !(key < pending[g].key); g++) {
+                if (pending[g].insert) {
+                    count++;
+                } else if (count > 0) {
+                    count--;
+                }
+            }
+            merged.insert(merged.end(), count, key);
+            i += present;
+        }
+        merged.insert(merged.end(), old.begin() + i, old.end());
+        pending.clear();
+        
+        std::uint64_t next = base->version + 1;
+        auto snapshot = std::make_shared<const Snapshot>(std::move(merged), next);
+        {
+            std::lock_guard<std::mutex> lock(publishMutex);
+            current = std::move(snapshot);
+        }
+        version.store(next, std::memory_order_release);
+    }
+    
+    static T selectIn(const Snapshot& s, SizeT k) {
+        if (k < 1 || k > (SizeT)s.keys.size()) {
+            throw std::out_of_range("Index out of range");
+        }
+        return s.keys[k - 1];
+    }
+    
+    static SizeT rankIn(const Snapshot& s, const T& key) {
+        auto it = std::lower_bound(s.keys.begin(), s.keys.end(), key);
+        if (it == s.keys.end() || key < *it) return -1;
+        return (it - s.keys.begin()) + 1;
+    }
+    
+    static SizeT rankOfIn(const Snapshot& s, const T& key) {
+        return (std::lower_bound(s.keys.begin(), s.keys.end(), key) - s.keys.begin()) + 1;
+    }
+
+public:
+    using value_type = T;
+    using size_type = SizeT;
+    
+    // Per-thread read handle; not itself safe to share between threads
+    class Reader {
+    private:
+        const ConcurrentOrderStatisticTree* tree;
+        std::shared_ptr<const Snapshot> snapshot;
+        
+        const Snapshot& fresh() {
+            if (tree->version.load(std::memory_order_acquire) != snapshot->version) {
+                snapshot = tree->acquire();
+            }
+            return *snapshot;
+        }
+    
+    public:
+        explicit Reader(const ConcurrentOrderStatisticTree& tree)
+            : tree(&tree), snapshot(tree.acquire()) {}
+        
+        T select(SizeT k) { return selectIn(fresh(), k); }
+        SizeT rank(const T& key) { return rankIn(fresh(), key); }
+        SizeT rankOf(const T& key) { return rankOfIn(fresh(), key); }
+        SizeT size() { return (SizeT)fresh().keys.size(); }
+        bool empty() { return fresh().keys.empty(); }
+        
+        // Published version this reader last saw
+        std::uint64_t seen() const { return snapshot->version; }
+    };
+    
+    explicit ConcurrentOrderStatisticTree(std::size_t batchSize = 1024)
+        : current(std::make_shared<const Snapshot>(std::vector<T>(), 0)), version(0),
+          batchSize(std::max<std::size_t>(1, batchSize)) {}
+    
+    // Start from a range that is already sorted
+    template<typename InputIt>
+    ConcurrentOrderStatisticTree(InputIt first, InputIt last, std::size_t batchSize = 1024)
+        : current(std::make_shared<const Snapshot>(std::vector<T>(first, last), 0)), version(0),
+          batchSize(std::max<std::size_t>(1, batchSize)) {}
+    
+    ConcurrentOrderStatisticTree(const ConcurrentOrderStatisticTree&) = delete;
+    ConcurrentOrderStatisticTree& operator=(const ConcurrentOrderStatisticTree&) = delete;
+    
+    void insert(const T& key) {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        pending.push_back(PendingOp{key, true});
+        if (pending.size() >= batchSize) commitLocked();
+    }
+    
+    void remove(const T& key) {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        pending.push_back(PendingOp{key, false});
+        if (pending.size() >= batchSize) commitLocked();
+    }
+    
+    // Publish every pending write now
+    void commit() {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        commitLocked();
+    }
+    
+    Reader reader() const {
+        return Reader(*this);
+    }
+    
+    T select(SizeT k) const { return selectIn(*acquire(), k); }
+    SizeT rank(const T& key) const { return rankIn(*acquire(), key); }
+    SizeT rankOf(const T& key) const { return rankOfIn(*acquire(), key); }
+    SizeT size() const { return (SizeT)acquire()->keys.size(); }
+    bool empty() const { return acquire()->keys.empty(); }
+    
+    std::uint64_t publishedVersion() const {
+        return version.load(std::memory_order_acquire);
+    }
+};
+
+#endif // OST_CONCURRENT_H
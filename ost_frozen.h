@@ -0,0 +1,171 @@
+#ifndef OST_FROZEN_H
+#define OST_FROZEN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "ost.h"
+
+/**
+ * Frozen Order Statistic Tree (Eytzinger layout)
+ * A read-only, pointer-free copy of an OrderStatisticTree for trees that
+ * have stopped changing:
+ * - the keys in order, so select(k) is a single array load
+ * - an Eytzinger (BFS-order) array of {key, number of smaller positions}
+ *   slots: node i has children 2i and 2i + 1, so a rank descent walks
+ *   one implicit level per step with no pointers to follow
+ *
+ * The descent is branchless: each step is k = 2k + (slot[k].key < key),
+ * which compiles to a compare and add instead of a mispredicting branch.
+ * While it runs, the slots four levels down (16 consecutive entries, kept
+ * cache-line aligned) are prefetched, so memory latency overlaps with the
+ * remaining comparisons. Each slot also carries its in-order rank (a
+ * prefix count), so no second pass turns the found slot into a position.
+ *
+ * Built in O(n) by freeze(tree); the source tree is left unchanged.
+ * rank() returns the first position of an equal key (the tree's rank()
+ * may return any of them); rankOf() matches the tree exactly.
+ */
+
+template<typename T, typename SizeT = int>
+class FrozenOrderStatisticTree {
+    static_assert(std::is_signed<SizeT>::value, "SizeT must be signed (rank returns -1)");
+
+private:
+    struct Slot {
+        T key;
+        SizeT before;  // Number of elements that precede this one
+    };
+    
+    static constexpr std::size_t CACHE_LINE = 64;
+    static constexpr std::size_t PREFETCH_SPAN = 16;  // Slots four levels below k
+    
+    std::vector<T> sorted;
+    std::vector<Slot> storage;
+    Slot* slots;  // 1-indexed view into storage; slots[0] is cache-line aligned
+    std::size_t n;
+    
+    // In-order fill of the implicit tree rooted at k
+    void layout(std::size_t k, std::size_t& next) {
+        if (k > n) return;
+        layout(2 * k, next);
+        slots[k].key = sorted[next];
+        slots[k].before = (SizeT)next;
+        next++;
+        layout(2 * k + 1, next);
+    }
+    
+    void prefetch(std::size_t k) const {
+#if defined(__GNUC__)
+        // Address arithmetic only: prefetching past the end cannot fault
+        std::uintptr_t p = reinterpret_cast<std::uintptr_t>(slots) + k * sizeof(Slot);
+        for (std::size_t line = 0; line < PREFETCH_SPAN * sizeof(Slot); line += CACHE_LINE) {
+            __builtin_prefetch(reinterpret_cast<const void*>(p + line));
+        }
+#else
+        (void)k;
+#endif
+    }
+    
+    // Eytzinger index of the first key >= key, or 0 if every key is smaller
+    std::size_t lowerBoundSlot(const T& key) const {
+        std::size_t k = 1;
+        while (k <= n) {
+            prefetch(PREFETCH_SPAN * k);
+            k = 2 * k + (slots[k].key < key);
+        }
+        // Undo the trailing right turns plus the final left turn
+        return k >> (__builtin_ctzll(~(unsigned long long)k) + 1);
+    }
+
+public:
+    using value_type = T;
+    using size_type = SizeT;
+    
+    FrozenOrderStatisticTree() : slots(nullptr), n(0) {}
+    
+    // From a range that is already sorted
+    template<typename InputIt,
+             typename = typename std::iterator_traits<InputIt>::iterator_category>
+    FrozenOrderStatisticTree(InputIt first, InputIt last)
+        : FrozenOrderStatisticTree(std::vector<T>(first, last)) {}
+    
+    // Takes ownership of keys already in sorted order
+    explicit FrozenOrderStatisticTree(std::vector<T> sortedKeys)
+        : sorted(std::move(sortedKeys)), n(sorted.size()) {
+        // Slack so the view can start on a cache line; then the 16 slots
+        // prefetched at 16k share as few lines as possible
+        std::size_t pad = CACHE_LINE / sizeof(Slot) + 1;
+        storage.resize(n + 1 + pad);
+        std::size_t shift = 0;
+        while (shift < pad &&
+               reinterpret_cast<std::uintptr_t>(storage.data() + shift) % CACHE_LINE != 0) {
+            shift++;
+        }
+        if (shift == pad) shift = 0;  // Slot size does not divide a line
+        slots = storage.data() + shift;
+        
+        std::size_t next = 0;
+        layout(1, next);
+    }
+    
+    FrozenOrderStatisticTree(const FrozenOrderStatisticTree&) = delete;
+    FrozenOrderStatisticTree& operator=(const FrozenOrderStatisticTree&) = delete;
+    
+    // Moving a vector keeps its buffer, so `slots` stays valid
+    FrozenOrderStatisticTree(FrozenOrderStatisticTree&& other) noexcept
+        : sorted(std::move(other.sorted)), storage(std::move(other.storage)),
+          slots(other.slots), n(other.n) {
+        other.slots = nullptr;
+        other.n = 0;
+    }
+    
+    FrozenOrderStatisticTree& operator=(FrozenOrderStatisticTree&& other) noexcept {
+        std::swap(sorted, other.sorted);
+        std::swap(storage, other.storage);
+        std::swap(slots, other.slots);
+        std::swap(n, other.n);
+        return *this;
+    }
+    
+    // Find k-th smallest element (1-indexed)
+    T select(SizeT k) const {
+        if (k < 1 || (std::size_t)k > n) {
+            throw std::out_of_range("Index out of range");
+        }
+        return sorted[k - 1];
+    }
+    
+    // Rank of the first element equal to key (1-indexed), -1 if absent
+    SizeT rank(const T& key) const {
+        std::size_t k = lowerBoundSlot(key);
+        if (k == 0 || key < slots[k].key) return -1;
+        return slots[k].before + 1;
+    }
+    
+    // Position key would take if inserted before any equal keys, i.e.
+    // 1 + number of elements < key (lower_bound). Works for absent keys.
+    SizeT rankOf(const T& key) const {
+        std::size_t k = lowerBoundSlot(key);
+        return k == 0 ? (SizeT)n + 1 : slots[k].before + 1;
+    }
+    
+    const T* begin() const { return sorted.data(); }
+    const T* end() const { return sorted.data() + n; }
+    SizeT size() const { return (SizeT)n; }
+    bool empty() const { return n == 0; }
+};
+
+// Read-only Eytzinger copy of tree, built in O(n)
+template<typename T, typename SizeT>
+FrozenOrderStatisticTree<T, SizeT> freeze(OrderStatisticTree<T, SizeT>& tree) {
+    std::vector<T> keys;
+    keys.reserve(tree.size());
+    tree.forEach([&](const T& key) { keys.push_back(key); });
+    return FrozenOrderStatisticTree<T, SizeT>(std::move(keys));
+}
+
+#endif // OST_FROZEN_H
@@ -4,6 +4,15 @@
 #include <iostream>
 #include <algorithm>
 #include <limits>
+#include <climits>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <cstdint>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "augmented_rbtree.h"
 
 /**
  * POM Tree (Partially Ordered Maximum Tree)
@@ -15,9 +24,39 @@
  * Supports O(log n) operations for:
  * - interval insertion/deletion
  * - finding maximum prefix sum in any interval
+ * - range queries: maximum prefix sum over starts in [a, b), prefix sums
+ * - batched insert/remove that relink the whole tree once
+ * - split (by start) and join in O(log n)
+ *
+ * In POM_INCREMENTAL mode (the default) each mutation recomputes the
+ * affected path once and stops at the first unchanged ancestor.
+ *
+ * addRange(a, b, delta) adds delta to every interval with start in [a, b)
+ * in O(log n) amortized, through lazy tags (see addRange). The extra
+ * per-node state it needs is only maintained once it has been called.
+ *
+ * insert returns a POMHandle; erase(handle) removes that interval without
+ * a search. enableIndex() adds a (start, end) hash index that remove()
+ * uses instead of descending the tree.
+ *
+ * Built with -DTREE_STATS, stats() reports rotations, fixup iterations,
+ * summary updates and descent depths per operation type.
+ *
+ * The red-black core is AugmentedRBTree (augmented_rbtree.h) with the
+ * POMMonoid policy below; BasicPOMTree adds the interval-specific
+ * operations. POMSubarrayTree swaps in POMSubarrayMonoid, which also keeps
+ * the maximum suffix and maximum subarray (best run of consecutive
+ * intervals) with their bounds, at a larger node and without addRange.
+ *
+ * Nodes are allocated from a NodePool slab, so teardown releases whole
+ * blocks instead of deleting nodes one at a time.
  */
 
-enum POMColor { POM_RED, POM_BLACK };
+// How insert/remove keep AugmentedData up to date:
+// - POM_FULL_PATH: run the fixup first, then recompute every ancestor
+// - POM_INCREMENTAL: recompute the path once before the fixup (so rotations
+//   see exact children) and stop climbing at the first unchanged node
+enum POMUpdateMode { POM_FULL_PATH, POM_INCREMENTAL };
 
 struct Interval {
     int start;
@@ -42,364 +81,725 @@ struct AugmentedData {
         : sum(s), maxpref(mp), argmax(am) {}
 };
 
-struct POMNode {
-    Interval interval;
-    POMColor color;
-    AugmentedData data;
-    POMNode* left;
-    POMNode* right;
-    POMNode* parent;
-    
-    POMNode(Interval iv) : interval(iv), color(POM_RED), 
-                           left(nullptr), right(nullptr), parent(nullptr) {
-        data.sum = iv.value;
-        data.maxpref = iv.value;
-        data.argmax = iv.start;
-    }
-};
-
-class POMTree {
-private:
-    POMNode* root;
-    POMNode* nil;
+// Monoid policy behind POMTree: sum, maxpref and argmax per subtree, plus
+// the per-node state the lazy range-add of POMTree::addRange needs
+struct POMMonoid {
+    using Summary = AugmentedData;
     
-    void leftRotate(POMNode* x) {
-        POMNode* y = x->right;
-        x->right = y->left;
+    // Lazy range-add state, kept after the fields every operation touches.
+    // After adding d to every value in the subtree, maxpref becomes
+    // maxpref + d * bestCount as long as the same prefix stays best, which
+    // holds for meltDown <= d <= meltUp.
+    struct Tag {
+        long long meltUp;    // LLONG_MAX if no shift can change the best prefix
+        long long meltDown;  // LLONG_MIN likewise
+        long long lazy;      // Delta not yet applied to either child subtree
+        int bestCount;       // Intervals in the best prefix
         
-        if (y->left != nil) {
-            y->left->parent = x;
+        Tag() : meltUp(LLONG_MAX), meltDown(LLONG_MIN), lazy(0), bestCount(1) {}
+    };
+    
+    // Whether bestCount and the melt limits are kept up to date. Off until
+    // the first addRange, so trees that never shift pay nothing for them.
+    bool ranged = false;
+    
+    static AugmentedData identity() {
+        return AugmentedData();
+    }
+    
+    static AugmentedData single(const Interval& interval) {
+        return AugmentedData(interval.value, interval.value, interval.start);
+    }
+    
+    // Combine the data of two adjacent runs: every interval of `left`
+    // precedes every interval of `right`. An empty run has maxpref LLONG_MIN.
+    // The best prefix either ends inside `left` or extends into `right`
+    // (left.sum + right.maxpref); ties keep the earlier position.
+    static AugmentedData combine(const AugmentedData& left, const AugmentedData& right) {
+        AugmentedData result(left.sum + right.sum, left.maxpref, left.argmax);
+        if (right.maxpref != LLONG_MIN && left.sum + right.maxpref > result.maxpref) {
+            result.maxpref = left.sum + right.maxpref;
+            result.argmax = right.argmax;
         }
+        return result;
+    }
+    
+    static bool same(const AugmentedData& a, const AugmentedData& b) {
+        return a.sum == b.sum && a.maxpref == b.maxpref && a.argmax == b.argmax;
+    }
+    
+    bool sameTag(const Tag& a, const Tag& b) const {
+        return !ranged || (a.bestCount == b.bestCount &&
+                           a.meltUp == b.meltUp && a.meltDown == b.meltDown);
+    }
+    
+    template<typename Node>
+    void pull(Node* node, const Node* nil) const {
+        if (!ranged) {
+            // left subtree, then the node itself, then right subtree
+            // (the sentinel carries empty data, so nil children need no checks)
+            node->summary = combine(combine(node->left->summary, single(node->key)),
+                                    node->right->summary);
+            return;
+        }
+        Node* l = node->left;
+        Node* r = node->right;
         
-        y->parent = x->parent;
+        // The best prefix ends in the left subtree, at the node, or in the
+        // right subtree; the first maximum wins, exactly as
+        // combine(combine(left, node), right). The sentinel's maxpref is
+        // LLONG_MIN, so an empty left side never wins.
+        long long through = l->summary.sum + node->key.value;
+        int throughCount = l->size + 1;
+        long long best = through;
+        int count = throughCount;
+        int at = node->key.start;
+        bool fromLeft = l->summary.maxpref >= through;
+        if (fromLeft) {
+            best = l->summary.maxpref;
+            count = l->tag.bestCount;
+            at = l->summary.argmax;
+        }
+        bool fromRight = r != nil && through + r->summary.maxpref > best;
+        if (fromRight) {
+            best = through + r->summary.maxpref;
+            count = throughCount + r->tag.bestCount;
+            at = r->summary.argmax;
+        }
+        node->summary = AugmentedData(through + r->summary.sum, best, at);
+        node->tag.bestCount = count;
         
-        if (x->parent == nil) {
-            root = y;
-        } else if (x == x->parent->left) {
-            x->parent->left = y;
+        // Under a shift d every candidate moves by d * (its count). The
+        // winner keeps winning until a longer candidate overtakes it or a
+        // shorter one (which wins ties) catches up; the children's own
+        // limits bound their candidates. The sentinel's are infinite.
+        long long up = std::min(l->tag.meltUp, r->tag.meltUp);
+        long long down = std::max(l->tag.meltDown, r->tag.meltDown);
+        if (fromRight) {
+            down = std::max(down, lowerLimit(best - through, count - throughCount));
+            if (l != nil) {
+                down = std::max(down, lowerLimit(best - l->summary.maxpref,
+                                                 count - l->tag.bestCount));
+            }
+        } else if (fromLeft) {
+            up = std::min(up, upperLimit(best - through, throughCount - count));
+            if (r != nil) {
+                up = std::min(up, upperLimit(best - through - r->summary.maxpref,
+                                             throughCount + r->tag.bestCount - count));
+            }
         } else {
-            x->parent->right = y;
+            if (l != nil) {
+                down = std::max(down, lowerLimit(best - l->summary.maxpref,
+                                                 count - l->tag.bestCount));
+            }
+            if (r != nil) {
+                up = std::min(up, upperLimit(-r->summary.maxpref, r->tag.bestCount));
+            }
         }
-        
-        y->left = x;
-        x->parent = y;
-        
-        updateAugmentedData(x);
-        updateAugmentedData(y);
+        node->tag.meltUp = up;
+        node->tag.meltDown = down;
     }
     
-    void rightRotate(POMNode* y) {
-        POMNode* x = y->left;
-        y->left = x->right;
-        
-        if (x->right != nil) {
-            x->right->parent = y;
-        }
-        
-        x->parent = y->parent;
-        
-        if (y->parent == nil) {
-            root = x;
-        } else if (y == y->parent->right) {
-            y->parent->right = x;
+    // Hand x's pending delta to its children. The tree pushes every node
+    // whose children it reads or whose subtrees it moves.
+    template<typename Node>
+    void push(Node* x, const Node* nil) const {
+        if (!ranged || x->tag.lazy == 0) return;
+        long long delta = x->tag.lazy;
+        x->tag.lazy = 0;
+        applyDelta(x->left, delta, nil);
+        applyDelta(x->right, delta, nil);
+    }
+    
+    // Add delta to every value in subtree x. Inside the melt limits the
+    // best prefix is unchanged and the data shifts in O(1); past them the
+    // tag is pushed down and x recomputed from its children.
+    template<typename Node>
+    void applyDelta(Node* x, long long delta, const Node* nil) const {
+        if (x == nil || delta == 0) return;
+        x->key.value += (int)delta;
+        x->tag.lazy += delta;
+        if (delta <= x->tag.meltUp && delta >= x->tag.meltDown) {
+            x->summary.sum += delta * x->size;
+            x->summary.maxpref += delta * x->tag.bestCount;
+            if (x->tag.meltUp != LLONG_MAX) x->tag.meltUp -= delta;
+            if (x->tag.meltDown != LLONG_MIN) x->tag.meltDown -= delta;
         } else {
-            y->parent->left = x;
+            push(x, nil);
+            pull(x, nil);
         }
-        
-        x->right = y;
-        y->parent = x;
-        
-        updateAugmentedData(y);
-        updateAugmentedData(x);
     }
     
-    void updateAugmentedData(POMNode* node) {
-        if (node == nil) return;
+    // Largest shift d >= 0 at which a winner `gap` ahead still beats a
+    // candidate with `slope` more intervals (ties keep the winner).
+    // A non-positive slope can only appear transiently, mid-rebalance,
+    // before the stale child is recomputed; it imposes no limit.
+    static long long upperLimit(long long gap, int slope) {
+        return slope > 0 ? gap / slope : LLONG_MAX;
+    }
+    
+    // Smallest shift d <= 0 at which a winner `gap` > 0 ahead still beats a
+    // candidate with `slope` fewer intervals (which would win a tie)
+    static long long lowerLimit(long long gap, int slope) {
+        return slope > 0 ? 1 - (gap + slope - 1) / slope : LLONG_MIN;
+    }
+};
+
+// Best suffix and best contiguous run on top of the prefix data. A run is
+// a sequence of consecutive intervals in start order; ties keep the run
+// that starts first, then the one that ends first (as argmax keeps the
+// earliest prefix). The counts let combine compare positions.
+struct SubarrayData : AugmentedData {
+    long long maxsuf;  // Maximum suffix sum
+    long long maxsub;  // Maximum sum of a contiguous run
+    int sufStart;      // Start of the first interval of the best suffix
+    int subStart;      // Start of the first interval of the best run
+    int subEnd;        // Start of the last interval of the best run
+    int count;         // Number of intervals summarized
+    int sufLen;        // Intervals in the best suffix
+    int subFirst;      // Position of the best run's first interval (0-based)
+    
+    SubarrayData() : maxsuf(LLONG_MIN), maxsub(LLONG_MIN), sufStart(-1), subStart(-1),
+                     subEnd(-1), count(0), sufLen(0), subFirst(0) {}
+};
+
+// Monoid policy behind POMSubarrayTree: POMMonoid's sum/maxpref/argmax plus
+// maxsuf and maxsub with their bounds. No lazy tag, so no addRange.
+struct POMSubarrayMonoid {
+    using Summary = SubarrayData;
+    
+    static SubarrayData identity() {
+        return SubarrayData();
+    }
+    
+    static SubarrayData single(const Interval& interval) {
+        SubarrayData d;
+        d.sum = d.maxpref = d.maxsuf = d.maxsub = interval.value;
+        d.argmax = d.sufStart = d.subStart = d.subEnd = interval.start;
+        d.count = d.sufLen = 1;
+        d.subFirst = 0;
+        return d;
+    }
+    
+    static SubarrayData combine(const SubarrayData& left, const SubarrayData& right) {
+        if (left.count == 0) return right;
+        if (right.count == 0) return left;
+        SubarrayData result;
+        static_cast<AugmentedData&>(result) = POMMonoid::combine(left, right);
+        result.count = left.count + right.count;
         
-        // Sum: left.sum + node.value + right.sum
-        node->data.sum = node->interval.value;
-        if (node->left != nil) {
-            node->data.sum += node->left->data.sum;
-        }
-        if (node->right != nil) {
-            node->data.sum += node->right->data.sum;
+        // Best suffix: right's own, or all of right after left's best
+        // suffix, which starts earlier and so wins ties
+        result.maxsuf = right.maxsuf;
+        result.sufStart = right.sufStart;
+        result.sufLen = right.sufLen;
+        if (right.sum + left.maxsuf >= right.maxsuf) {
+            result.maxsuf = right.sum + left.maxsuf;
+            result.sufStart = left.sufStart;
+            result.sufLen = right.count + left.sufLen;
         }
         
-        // MaxPref computation
-        // Three cases:
-        // 1. Maxpref is in left subtree
-        // 2. Maxpref includes current node (left.sum + node.value)
-        // 3. Maxpref extends to right subtree
-        
-        long long leftSum = (node->left != nil) ? node->left->data.sum : 0;
-        long long leftMaxPref = (node->left != nil) ? node->left->data.maxpref : LLONG_MIN;
-        long long rightMaxPref = (node->right != nil) ? node->right->data.maxpref : LLONG_MIN;
-        
-        // Case 1: maxpref is entirely in left subtree
-        node->data.maxpref = leftMaxPref;
-        node->data.argmax = (node->left != nil) ? node->left->data.argmax : -1;
-        
-        // Case 2: maxpref includes current node
-        long long prefixAtNode = leftSum + node->interval.value;
-        if (prefixAtNode > node->data.maxpref) {
-            node->data.maxpref = prefixAtNode;
-            node->data.argmax = node->interval.start;
+        // Best run: inside left, across the boundary (left's best suffix
+        // then right's best prefix), or inside right, which starts last
+        result.maxsub = left.maxsub;
+        result.subStart = left.subStart;
+        result.subEnd = left.subEnd;
+        result.subFirst = left.subFirst;
+        long long across = left.maxsuf + right.maxpref;
+        int acrossFirst = left.count - left.sufLen;
+        if (across > result.maxsub || (across == result.maxsub && acrossFirst < result.subFirst)) {
+            result.maxsub = across;
+            result.subStart = left.sufStart;
+            result.subEnd = right.argmax;
+            result.subFirst = acrossFirst;
         }
-        
-        // Case 3: maxpref extends into right subtree
-        if (node->right != nil && prefixAtNode + rightMaxPref > node->data.maxpref) {
-            node->data.maxpref = prefixAtNode + rightMaxPref;
-            node->data.argmax = node->right->data.argmax;
+        if (right.maxsub > result.maxsub) {
+            result.maxsub = right.maxsub;
+            result.subStart = right.subStart;
+            result.subEnd = right.subEnd;
+            result.subFirst = left.count + right.subFirst;
         }
+        return result;
     }
     
-    void insertFixup(POMNode* z) {
-        while (z->parent->color == POM_RED) {
-            if (z->parent == z->parent->parent->left) {
-                POMNode* y = z->parent->parent->right;
-                if (y->color == POM_RED) {
-                    z->parent->color = POM_BLACK;
-                    y->color = POM_BLACK;
-                    z->parent->parent->color = POM_RED;
-                    z = z->parent->parent;
-                } else {
-                    if (z == z->parent->right) {
-                        z = z->parent;
-                        leftRotate(z);
-                    }
-                    z->parent->color = POM_BLACK;
-                    z->parent->parent->color = POM_RED;
-                    rightRotate(z->parent->parent);
-                }
-            } else {
-                POMNode* y = z->parent->parent->left;
-                if (y->color == POM_RED) {
-                    z->parent->color = POM_BLACK;
-                    y->color = POM_BLACK;
-                    z->parent->parent->color = POM_RED;
-                    z = z->parent->parent;
-                } else {
-                    if (z == z->parent->left) {
-                        z = z->parent;
-                        rightRotate(z);
-                    }
-                    z->parent->color = POM_BLACK;
-                    z->parent->parent->color = POM_RED;
-                    leftRotate(z->parent->parent);
-                }
-            }
+    static bool same(const SubarrayData& a, const SubarrayData& b) {
+        return POMMonoid::same(a, b) && a.maxsuf == b.maxsuf && a.maxsub == b.maxsub &&
+               a.sufStart == b.sufStart && a.subStart == b.subStart && a.subEnd == b.subEnd &&
+               a.count == b.count && a.sufLen == b.sufLen && a.subFirst == b.subFirst;
+    }
+};
+
+// Stable reference to one stored interval, returned by POMTree::insert.
+// Rotations and other updates never move an interval to another node, so
+// a handle stays valid until its interval is removed or its tree cleared.
+template<typename Node>
+struct BasicPOMHandle {
+    Node* node;
+    
+    BasicPOMHandle() : node(nullptr) {}
+    explicit BasicPOMHandle(Node* node) : node(node) {}
+    
+    const Interval& interval() const { return node->key; }
+    bool valid() const { return node != nullptr; }
+};
+
+// POM operations over the red-black core, for either monoid:
+// - POMTree (POMMonoid): sum/maxpref/argmax, with lazy addRange
+// - POMSubarrayTree (POMSubarrayMonoid): also maxsuf/maxsub and their
+//   bounds, at about twice the summary size and no addRange
+template<typename Monoid>
+class BasicPOMTree : public AugmentedRBTree<Interval, void, Monoid> {
+public:
+    using Base = AugmentedRBTree<Interval, void, Monoid>;
+    using Node = typename Base::Node;
+    using Summary = typename Base::Summary;
+    using Handle = BasicPOMHandle<Node>;
+
+private:
+    using Base::hasTag;
+    using Base::pool;
+    using Base::root;
+    using Base::nil;
+    using Base::monoid;
+    using Base::incremental;
+#ifdef TREE_STATS
+    using Base::treeStats;
+#endif
+    using Base::push;
+    using Base::pull;
+    using Base::createNode;
+    using Base::destroyNode;
+    using Base::insertNode;
+    using Base::unlinkNode;
+    using Base::successor;
+    using Base::minimum;
+    using Base::maximum;
+    using Base::collectInOrder;
+    using Base::linkAll;
+    using Base::preferRebuild;
+    
+    // Optional (start, end) -> node index; see enableIndex()
+    bool indexed;
+    std::unordered_multimap<std::uint64_t, Node*> index;
+    
+    // Ranks of equal starts depend on insertion order, so POMTree offers
+    // no split by rank
+    using Base::splitByRank;
+    
+    // A split-off part of a tree, over the same pool
+    explicit BasicPOMTree(Base&& part) : Base(std::move(part)), indexed(false) {}
+    
+    // Switch on melt tracking: one post-order pass computes bestCount and
+    // the limits for every node
+    void startRanged() {
+        if (monoid.ranged) return;
+        monoid.ranged = true;
+        refreshAll(root);
+    }
+    
+    void refreshAll(Node* x) {
+        if (x == nil) return;
+        refreshAll(x->left);
+        refreshAll(x->right);
+        pull(x);
+    }
+    
+    // Add delta to intervals of subtree x with start >= a
+    void addFrom(Node* x, int a, long long delta) {
+        if (x == nil) return;
+        push(x);
+        if (x->key.start >= a) {
+            x->key.value += (int)delta;
+            monoid.applyDelta(x->right, delta, nil);
+            addFrom(x->left, a, delta);
+        } else {
+            addFrom(x->right, a, delta);
         }
-        root->color = POM_BLACK;
+        pull(x);
     }
     
-    void transplant(POMNode* u, POMNode* v) {
-        if (u->parent == nil) {
-            root = v;
-        } else if (u == u->parent->left) {
-            u->parent->left = v;
+    // Add delta to intervals of subtree x with start < b
+    void addBefore(Node* x, int b, long long delta) {
+        if (x == nil) return;
+        push(x);
+        if (x->key.start < b) {
+            x->key.value += (int)delta;
+            monoid.applyDelta(x->left, delta, nil);
+            addBefore(x->right, b, delta);
         } else {
-            u->parent->right = v;
+            addBefore(x->left, b, delta);
         }
-        v->parent = u->parent;
+        pull(x);
     }
     
-    POMNode* minimum(POMNode* x) {
-        while (x->left != nil) {
-            x = x->left;
+    // Add delta to intervals of subtree x with start in [a, b)
+    void addWithin(Node* x, int a, int b, long long delta) {
+        if (x == nil) return;
+        push(x);
+        if (x->key.start < a) {
+            addWithin(x->right, a, b, delta);
+        } else if (x->key.start >= b) {
+            addWithin(x->left, a, b, delta);
+        } else {
+            x->key.value += (int)delta;
+            addFrom(x->left, a, delta);
+            addBefore(x->right, b, delta);
         }
-        return x;
-    }
-    
-    void deleteFixup(POMNode* x) {
-        while (x != root && x->color == POM_BLACK) {
-            if (x == x->parent->left) {
-                POMNode* w = x->parent->right;
-                if (w->color == POM_RED) {
-                    w->color = POM_BLACK;
-                    x->parent->color = POM_RED;
-                    leftRotate(x->parent);
-                    w = x->parent->right;
-                }
-                if (w->left->color == POM_BLACK && w->right->color == POM_BLACK) {
-                    w->color = POM_RED;
-                    x = x->parent;
-                } else {
-                    if (w->right->color == POM_BLACK) {
-                        w->left->color = POM_BLACK;
-                        w->color = POM_RED;
-                        rightRotate(w);
-                        w = x->parent->right;
-                    }
-                    w->color = x->parent->color;
-                    x->parent->color = POM_BLACK;
-                    w->right->color = POM_BLACK;
-                    leftRotate(x->parent);
-                    x = root;
-                }
+        pull(x);
+    }
+    
+    // First interval in order with this start and end. Rotations can leave
+    // equal starts on both sides of one another, so descend to the leftmost
+    // node with the start and walk the run of equal starts from there.
+    Node* search(Node* x, const Interval& interval) {
+        Node* first = nil;
+        while (x != nil) {
+            TREE_STATS_COUNT(nodesVisited);
+            if (x->key.start < interval.start) {
+                x = x->right;
             } else {
-                POMNode* w = x->parent->left;
-                if (w->color == POM_RED) {
-                    w->color = POM_BLACK;
-                    x->parent->color = POM_RED;
-                    rightRotate(x->parent);
-                    w = x->parent->left;
-                }
-                if (w->right->color == POM_BLACK && w->left->color == POM_BLACK) {
-                    w->color = POM_RED;
-                    x = x->parent;
-                } else {
-                    if (w->left->color == POM_BLACK) {
-                        w->right->color = POM_BLACK;
-                        w->color = POM_RED;
-                        leftRotate(w);
-                        w = x->parent->left;
-                    }
-                    w->color = x->parent->color;
-                    x->parent->color = POM_BLACK;
-                    w->left->color = POM_BLACK;
-                    rightRotate(x->parent);
-                    x = root;
-                }
+                first = x;
+                x = x->left;
             }
         }
-        x->color = POM_BLACK;
+        for (x = first; x != nil && x->key.start == interval.start; x = successor(x)) {
+            TREE_STATS_COUNT(nodesVisited);
+            if (x->key.end == interval.end) return x;
+        }
+        return nil;
     }
     
-    POMNode* search(POMNode* x, const Interval& interval) {
-        while (x != nil && !(interval.start == x->interval.start && 
-                             interval.end == x->interval.end)) {
-            if (interval < x->interval) {
-                x = x->left;
-            } else {
-                x = x->right;
+    // In-order position of x (1-indexed), climbing through the sizes
+    int position(Node* x) {
+        int pos = x->left->size + 1;
+        for (; x->parent != nil; x = x->parent) {
+            if (x == x->parent->right) {
+                pos += x->parent->left->size + 1;
             }
         }
-        return x;
+        return pos;
     }
     
-    void destroyTree(POMNode* node) {
-        if (node != nil) {
-            destroyTree(node->left);
-            destroyTree(node->right);
-            delete node;
-        }
+    static std::uint64_t indexKey(const Interval& interval) {
+        return ((std::uint64_t)(std::uint32_t)interval.start << 32) | (std::uint32_t)interval.end;
     }
     
-    void updateAncestors(POMNode* node) {
-        while (node != nil) {
-            updateAugmentedData(node);
-            node = node->parent;
+    void indexInsert(Node* node) {
+        if (indexed) index.emplace(indexKey(node->key), node);
+    }
+    
+    void indexErase(Node* node) {
+        if (!indexed) return;
+        auto range = index.equal_range(indexKey(node->key));
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == node) {
+                index.erase(it);
+                return;
+            }
         }
     }
     
+    void rebuildIndex() {
+        index.clear();
+        if (!indexed) return;
+        std::vector<Node*> nodes;
+        collectInOrder(root, nodes);
+        index.reserve(nodes.size());
+        for (Node* x : nodes) {
+            index.emplace(indexKey(x->key), x);
+        }
+    }
+
 public:
-    POMTree() {
-        nil = new POMNode(Interval());
-        nil->color = POM_BLACK;
-        nil->left = nil->right = nil->parent = nil;
-        nil->data = AugmentedData();
-        root = nil;
+    // Public so other POM variants fold their data the same way
+    static Summary combine(const Summary& left, const Summary& right) {
+        return Monoid::combine(left, right);
     }
     
-    ~POMTree() {
-        destroyTree(root);
-        delete nil;
+    static Summary single(const Interval& interval) {
+        return Monoid::single(interval);
     }
     
-    void insert(Interval interval) {
-        POMNode* z = new POMNode(interval);
-        z->left = z->right = nil;
-        
-        POMNode* y = nil;
-        POMNode* x = root;
+    explicit BasicPOMTree(POMUpdateMode mode = POM_INCREMENTAL) : indexed(false) {
+        incremental = (mode == POM_INCREMENTAL);
+    }
+    
+    // The moved-from tree is left empty, still sharing the pool
+    BasicPOMTree(BasicPOMTree&& other) noexcept
+        : Base(std::move(other)), indexed(other.indexed), index(std::move(other.index)) {
+        other.index.clear();
+    }
+    
+    BasicPOMTree& operator=(BasicPOMTree&& other) noexcept {
+        Base::operator=(std::move(other));
+        std::swap(indexed, other.indexed);
+        std::swap(index, other.index);
+        return *this;
+    }
+    
+    void clear() {
+        index.clear();
+        Base::clear();
+    }
+    
+    // Replace the contents with intervals already sorted by start, in O(n):
+    // no descents or rotations, each node's data is computed once
+    template<typename InputIt>
+    void buildFromSorted(InputIt first, InputIt last) {
+        index.clear();
+        Base::buildFromSorted(first, last);
+        rebuildIndex();
+    }
+    
+    // Returns a handle for erase(); ignoring it is fine
+    Handle insert(Interval interval) {
+        TREE_STATS_SCOPE(TREE_OP_INSERT);
+        Node* z = insertNode(createNode(interval));
+        indexInsert(z);
+        return Handle(z);
+    }
+    
+    // Build the interval in place from Interval's constructor arguments;
+    // same index upkeep and handle as insert()
+    template<typename... Args>
+    Handle emplace(Args&&... args) {
+        TREE_STATS_SCOPE(TREE_OP_INSERT);
+        Node* z = insertNode(createNode(std::forward<Args>(args)...));
+        indexInsert(z);
+        return Handle(z);
+    }
+    
+    // Remove one interval with this start and end, if present. Uses the
+    // hash index when enabled; otherwise one descent plus a walk over the
+    // intervals sharing the start.
+    void remove(Interval interval) {
+        TREE_STATS_SCOPE(TREE_OP_REMOVE);
+        if (!indexed) {
+            Node* z = search(root, interval);
+            if (z != nil) erase(Handle(z));
+            return;
+        }
         
-        while (x != nil) {
-            y = x;
-            if (z->interval < x->interval) {
-                x = x->left;
-            } else {
-                x = x->right;
+        auto range = index.equal_range(indexKey(interval));
+        if (range.first == range.second) return;
+        // Among identical (start, end) entries take the first in order,
+        // the same one search() finds
+        auto chosen = range.first;
+        if (std::next(chosen) != range.second) {
+            int best = position(chosen->second);
+            for (auto it = std::next(chosen); it != range.second; ++it) {
+                int pos = position(it->second);
+                if (pos < best) {
+                    chosen = it;
+                    best = pos;
+                }
             }
         }
-        
-        z->parent = y;
-        
-        if (y == nil) {
-            root = z;
-        } else if (z->interval < y->interval) {
-            y->left = z;
-        } else {
-            y->right = z;
+        Node* z = chosen->second;
+        index.erase(chosen);
+        unlinkNode(z);
+        destroyNode(z);
+    }
+    
+    // Remove the interval behind a handle from insert(), with no search.
+    // Only the path from its node to the root is refreshed: O(log n).
+    void erase(Handle handle) {
+        TREE_STATS_SCOPE(TREE_OP_REMOVE);
+        if (!handle.valid()) {
+            throw std::invalid_argument("erase: invalid handle");
         }
-        
-        z->color = POM_RED;
-        insertFixup(z);
-        updateAncestors(z);
+        indexErase(handle.node);
+        unlinkNode(handle.node);
+        destroyNode(handle.node);
     }
     
-    void remove(Interval interval) {
-        POMNode* z = search(root, interval);
-        if (z == nil) return;
-        
-        POMNode* updateStart = z->parent;
-        
-        POMNode* y = z;
-        POMNode* x;
-        POMColor yOriginalColor = y->color;
+    // Keep an unordered (start, end) -> node index so remove() skips the
+    // tree search. Costs one hash entry per interval; split and join
+    // rebuild it in O(n).
+    void enableIndex() {
+        indexed = true;
+        rebuildIndex();
+    }
+    
+    void disableIndex() {
+        indexed = false;
+        index.clear();
+    }
+    
+    bool isIndexed() const {
+        return indexed;
+    }
+    
+    // Keep intervals with start < key here and return a tree holding
+    // those with start >= key. O(log n); both trees share the node pool.
+    // Both halves keep melt tracking as it was, their limits are current.
+    BasicPOMTree splitByKey(int key) {
+        BasicPOMTree rest(Base::splitByKey(Interval(key, key, 0)));
+        if (indexed) {
+            rebuildIndex();
+            rest.enableIndex();
+        }
+        return rest;
+    }
+    
+    // Append every interval of other, whose starts must be >= every start
+    // here; other is left empty. O(log n) when both trees share a pool
+    // (e.g. one was split off the other); otherwise other's intervals are
+    // first copied into this pool in O(m).
+    void join(BasicPOMTree& other) {
+        if (other.empty()) return;
+        if (!this->empty() && other.minimum(other.root)->key.start < maximum(root)->key.start) {
+            throw std::invalid_argument("join: starts of other must not precede this tree");
+        }
+        if constexpr (hasTag) {
+            if (other.monoid.ranged) startRanged();
+            if (monoid.ranged) other.startRanged();
+        }
         
-        if (z->left == nil) {
-            x = z->right;
-            transplant(z, z->right);
-        } else if (z->right == nil) {
-            x = z->left;
-            transplant(z, z->left);
-        } else {
-            y = minimum(z->right);
-            yOriginalColor = y->color;
-            x = y->right;
-            updateStart = y->parent;
-            
-            if (y->parent == z) {
-                x->parent = y;
-                updateStart = y;
+        other.index.clear();
+        Base::join(other);
+        rebuildIndex();
+    }
+    
+    // Find maximum prefix sum and its position
+    Summary findPOM() {
+        TREE_STATS_SCOPE(TREE_OP_QUERY);
+        return this->summary();
+    }
+    
+    // Maximum prefix sum over intervals with start in [a, b), in O(log n).
+    // Prefixes begin at the first interval whose start is >= a; argmax is
+    // the start of the interval ending the best prefix (-1 if none).
+    Summary findPOM(int a, int b) {
+        return this->fold(Interval(a, a, 0), Interval(b, b, 0));
+    }
+    
+    // Sum of values of all intervals with start <= x, in O(log n)
+    long long prefixSumAt(int x) {
+        TREE_STATS_SCOPE(TREE_OP_QUERY);
+        long long sum = 0;
+        Node* node = root;
+        while (node != nil) {
+            TREE_STATS_COUNT(nodesVisited);
+            push(node);
+            if (node->key.start <= x) {
+                sum += node->left->summary.sum + node->key.value;
+                node = node->right;
             } else {
-                transplant(y, y->right);
-                y->right = z->right;
-                y->right->parent = y;
+                node = node->left;
             }
-            
-            transplant(z, y);
-            y->left = z->left;
-            y->left->parent = y;
-            y->color = z->color;
+        }
+        return sum;
+    }
+    
+    // Add delta to the value of every interval with start in [a, b).
+    // Whole subtrees inside the range take a lazy tag, so only the two
+    // boundary paths are visited. A tagged subtree whose best prefix
+    // changes under the shift is recomputed from its children, which
+    // can cascade; that work is paid once per change of best prefix, so
+    // the cost is O(log n) amortized while the best prefixes are stable.
+    // Values stay ints.
+    void addRange(int a, int b, int delta) {
+        static_assert(hasTag, "addRange needs the lazy tags of POMMonoid");
+        TREE_STATS_SCOPE(TREE_OP_UPDATE);
+        if (a >= b || delta == 0) return;
+        startRanged();
+        addWithin(root, a, b, delta);
+    }
+    
+    // Insert a batch of intervals. Large batches are sorted by start,
+    // merged with the existing nodes in one pass and relinked, so each
+    // node's sum/maxpref/argmax is recomputed once for the whole batch.
+    template<typename InputIt>
+    void insertBatch(InputIt first, InputIt last) {
+        std::vector<Interval> batch(first, last);
+        if (!preferRebuild(size(), batch.size())) {
+            for (const Interval& iv : batch) {
+                insert(iv);
+            }
+            return;
         }
         
-        delete z;
+        std::stable_sort(batch.begin(), batch.end());
+        std::vector<Node*> existing;
+        existing.reserve(size());
+        collectInOrder(root, existing);
         
-        if (yOriginalColor == POM_BLACK) {
-            deleteFixup(x);
+        std::vector<Node*> merged;
+        merged.reserve(existing.size() + batch.size());
+        std::size_t i = 0;
+        for (const Interval& iv : batch) {
+            // Equal starts go after existing ones, as insert() places them
+            while (i < existing.size() && !(iv < existing[i]->key)) {
+                merged.push_back(existing[i++]);
+            }
+            merged.push_back(createNode(iv));
+            indexInsert(merged.back());
         }
-        
-        updateAncestors(updateStart);
+        while (i < existing.size()) {
+            merged.push_back(existing[i++]);
+        }
+        linkAll(merged);
     }
     
-    // Find maximum prefix sum and its position
-    AugmentedData findPOM() {
-        if (root == nil) {
-            return AugmentedData();
+    // Remove one interval matching (start, end) for each batch entry
+    // (missing ones are ignored). Large batches are matched against the
+    // tree in one sorted sweep and the survivors relinked.
+    template<typename InputIt>
+    void removeBatch(InputIt first, InputIt last) {
+        std::vector<Interval> batch(first, last);
+        if (!preferRebuild(size(), batch.size())) {
+            for (const Interval& iv : batch) {
+                remove(iv);
+            }
+            return;
+        }
+        
+        std::sort(batch.begin(), batch.end(), [](const Interval& a, const Interval& b) {
+            return a.start < b.start || (a.start == b.start && a.end < b.end);
+        });
+        std::vector<char> taken(batch.size(), 0);
+        std::vector<Node*> nodes;
+        nodes.reserve(size());
+        collectInOrder(root, nodes);
+        
+        std::vector<Node*> kept;
+        kept.reserve(nodes.size());
+        std::size_t j = 0;
+        for (Node* x : nodes) {
+            while (j < batch.size() && batch[j].start < x->key.start) {
+                j++;
+            }
+            // Scan this start's entries for an unused one with the same end
+            std::size_t k = j;
+            while (k < batch.size() && batch[k].start == x->key.start &&
+                   (taken[k] || batch[k].end < x->key.end)) {
+                k++;
+            }
+            if (k < batch.size() && batch[k].start == x->key.start &&
+                batch[k].end == x->key.end) {
+                taken[k] = 1;
+                indexErase(x);
+                destroyNode(x);
+            } else {
+                kept.push_back(x);
+            }
         }
-        return root->data;
+        linkAll(kept);
     }
     
     long long getSum() {
-        if (root == nil) return 0;
-        return root->data.sum;
+        return root->summary.sum;
     }
     
-    bool empty() {
-        return root == nil;
+    std::size_t size() {
+        return root->size;
     }
 };
 
-#endif // POM_H
+using POMTree = BasicPOMTree<POMMonoid>;
+using POMSubarrayTree = BasicPOMTree<POMSubarrayMonoid>;
+using POMNode = POMTree::Node;
+using POMHandle = POMTree::Handle;
 
+#endif // POM_H
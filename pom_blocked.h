@@ -0,0 +1,457 @@
+#ifndef POM_BLOCKED_H
+#define POM_BLOCKED_H
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include "pom.h"
+#include "node_pool.h"
+#include "simd.h"
+
+/**
+ * Leaf-blocked POM Tree
+ * Same interval semantics as POMTree (ordered by start, equal starts in
+ * insertion order; sum / maxpref / argmax over the whole sequence), kept
+ * in a B+-tree whose leaves are blocks of up to LeafCapacity intervals:
+ * - leaves store starts, ends and values as separate arrays, so a leaf's
+ *   AugmentedData is one simd::maxPrefix scan over its values
+ * - inner nodes keep each child's size, sum, maxpref and argmax in arrays
+ *   and combine them with one simd::maxPrefixCombine scan
+ * - an update rescans one leaf and one slot array per level, instead of
+ *   recombining every node on a red-black path
+ *
+ * Separators bound children by start as in BTreeOrderStatisticTree
+ * (max start of child i <= seps[i] <= min start of child i + 1).
+ */
+
+template<int Fanout = 16, int LeafCapacity = 64>
+class BlockedPOMTree {
+    static_assert(Fanout >= 4, "Fanout must be at least 4");
+    static_assert(LeafCapacity >= 4, "LeafCapacity must be at least 4");
+
+private:
+    static constexpr int MIN_CHILDREN = Fanout / 2;
+    static constexpr int MIN_ENTRIES = LeafCapacity / 2;
+    
+    struct Node {
+        bool leaf;
+        int count;  // Intervals in a leaf, children in an inner node
+        
+        Node(bool leaf) : leaf(leaf), count(0) {}
+    };
+    
+    struct Leaf : Node {
+        Leaf* next;
+        int starts[LeafCapacity];
+        int ends[LeafCapacity];
+        int values[LeafCapacity];
+        
+        Leaf() : Node(true), next(nullptr) {}
+    };
+    
+    struct Inner : Node {
+        int sizes[Fanout];
+        long long sums[Fanout];
+        long long maxprefs[Fanout];
+        int argmaxes[Fanout];
+        int seps[Fanout - 1];
+        Node* child[Fanout];
+        
+        Inner() : Node(false) {}
+    };
+    
+    NodePool<Leaf> leafPool;
+    NodePool<Inner> innerPool;
+    Node* root;
+    AugmentedData rootData;
+    int total;
+    
+    // ---- Aggregates ----
+    
+    static AugmentedData computeData(const Node* node) {
+        if (node->leaf) {
+            const Leaf* leaf = static_cast<const Leaf*>(node);
+            simd::PrefixMax p = simd::maxPrefix(leaf->values, leaf->count);
+            return AugmentedData(p.sum, p.maxpref, p.argmax < 0 ? -1 : leaf->starts[p.argmax]);
+        }
+        const Inner* in = static_cast<const Inner*>(node);
+        simd::PrefixMax p = simd::maxPrefixCombine(in->sums, in->maxprefs, in->count);
+        return AugmentedData(p.sum, p.maxpref, p.argmax < 0 ? -1 : in->argmaxes[p.argmax]);
+    }
+    
+    static int nodeSize(const Node* node) {
+        if (node->leaf) return node->count;
+        const Inner* in = static_cast<const Inner*>(node);
+        int sum = 0;
+        for (int i = 0; i < in->count; i++) {
+            sum += in->sizes[i];
+        }
+        return sum;
+    }
+    
+    // Reload slot i of `in` from its child
+    static void refreshSlot(Inner* in, int i) {
+        AugmentedData d = computeData(in->child[i]);
+        in->sizes[i] = nodeSize(in->child[i]);
+        in->sums[i] = d.sum;
+        in->maxprefs[i] = d.maxpref;
+        in->argmaxes[i] = d.argmax;
+    }
+    
+    static void refreshAll(Inner* in) {
+        for (int i = 0; i < in->count; i++) {
+            refreshSlot(in, i);
+        }
+    }
+    
+    // ---- Leaf entry moves (three parallel arrays) ----
+    
+    static void copyEntries(const Leaf* src, int from, int n, Leaf* dst, int to) {
+        std::copy(src->starts + from, src->starts + from + n, dst->starts + to);
+        std::copy(src->ends + from, src->ends + from + n, dst->ends + to);
+        std::copy(src->values + from, src->values + from + n, dst->values + to);
+    }
+    
+    // Open a gap of one entry at pos
+    static void openGap(Leaf* leaf, int pos) {
+        std::copy_backward(leaf->starts + pos, leaf->starts + leaf->count, leaf->starts + leaf->count + 1);
+        std::copy_backward(leaf->ends + pos, leaf->ends + leaf->count, leaf->ends + leaf->count + 1);
+        std::copy_backward(leaf->values + pos, leaf->values + leaf->count, leaf->values + leaf->count + 1);
+        leaf->count++;
+    }
+    
+    static void closeGap(Leaf* leaf, int pos) {
+        copyEntries(leaf, pos + 1, leaf->count - pos - 1, leaf, pos);
+        leaf->count--;
+    }
+    
+    static void setEntry(Leaf* leaf, int pos, const Interval& iv) {
+        leaf->starts[pos] = iv.start;
+        leaf->ends[pos] = iv.end;
+        leaf->values[pos] = iv.value;
+    }
+    
+    // ---- Descent helpers ----
+    
+    // First child that may hold `start` (lookups)
+    static int childFor(const Inner* in, int start) {
+        int i = 0;
+        while (i < in->count - 1 && in->seps[i] < start) {
+            i++;
+        }
+        return i;
+    }
+    
+    // Child after every interval with this start (insertion keeps equal
+    // starts in insertion order, like POMTree)
+    static int childAfter(const Inner* in, int start) {
+        int i = 0;
+        while (i < in->count - 1 && in->seps[i] <= start) {
+            i++;
+        }
+        return i;
+    }
+    
+    static int upperBound(const Leaf* leaf, int start) {
+        return (int)(std::upper_bound(leaf->starts, leaf->starts + leaf->count, start) - leaf->starts);
+    }
+    
+    static int lowerBound(const Leaf* leaf, int start) {
+        return (int)(std::lower_bound(leaf->starts, leaf->starts + leaf->count, start) - leaf->starts);
+    }
+    
+    // ---- Insertion ----
+    
+    Node* insertInto(Node* node, const Interval& iv, int& sep) {
+        if (node->leaf) {
+            Leaf* leaf = static_cast<Leaf*>(node);
+            int pos = upperBound(leaf, iv.start);
+            if (leaf->count < LeafCapacity) {
+                openGap(leaf, pos);
+                setEntry(leaf, pos, iv);
+                return nullptr;
+            }
+            
+            Leaf* right = leafPool.create();
+            int half = (LeafCapacity + 1) / 2;
+            copyEntries(leaf, half, LeafCapacity - half, right, 0);
+            right->count = LeafCapacity - half;
+            leaf->count = half;
+            right->next = leaf->next;
+            leaf->next = right;
+            
+            Leaf* target = pos <= half ? leaf : right;
+            if (target == right) pos -= half;
+            openGap(target, pos);
+            setEntry(target, pos, iv);
+            
+            sep = leaf->starts[leaf->count - 1];
+            return right;
+        }
+        
+        Inner* in = static_cast<Inner*>(node);
+        int i = childAfter(in, iv.start);
+        int childSep;
+        Node* split = insertInto(in->child[i], iv, childSep);
+        if (split == nullptr) {
+            refreshSlot(in, i);
+            return nullptr;
+        }
+        return insertChild(in, i + 1, split, childSep, sep);
+    }
+    
+    // Place child at index `at` with seps[at - 1] = childSep, splitting a
+    // full node; slot aggregates of every touched node are reloaded
+    Node* insertChild(Inner* in, int at, Node* child, int childSep, int& sep) {
+        if (in->count < Fanout) {
+            for (int j = in->count; j > at; j--) {
+                copySlot(in, j - 1, in, j);
+            }
+            std::copy_backward(in->seps + at - 1, in->seps + in->count - 1, in->seps + in->count);
+            in->child[at] = child;
+            in->seps[at - 1] = childSep;
+            in->count++;
+            refreshSlot(in, at - 1);
+            refreshSlot(in, at);
+            return nullptr;
+        }
+        
+        Node* children[Fanout + 1];
+        int seps[Fanout];
+        for (int j = 0, src = 0; j <= Fanout; j++) {
+            children[j] = j == at ? child : in->child[src++];
+        }
+        for (int j = 0, src = 0; j < Fanout; j++) {
+            seps[j] = j == at - 1 ? childSep : in->seps[src++];
+        }
+        
+        Inner* right = innerPool.create();
+        int left = (Fanout + 1) / 2;
+        in->count = left;
+        right->count = Fanout + 1 - left;
+        std::copy(children, children + left, in->child);
+        std::copy(children + left, children + Fanout + 1, right->child);
+        std::copy(seps, seps + left - 1, in->seps);
+        std::copy(seps + left, seps + Fanout, right->seps);
+        sep = seps[left - 1];
+        refreshAll(in);
+        refreshAll(right);
+        return right;
+    }
+    
+    // ---- Removal ----
+    
+    void eraseFrom(Node* node, int k) {
+        if (node->leaf) {
+            closeGap(static_cast<Leaf*>(node), k - 1);
+            return;
+        }
+        
+        Inner* in = static_cast<Inner*>(node);
+        int i = simd::rankSlot(in->sizes, in->count, k);
+        eraseFrom(in->child[i], k);
+        
+        Node* c = in->child[i];
+        if (c->count >= (c->leaf ? MIN_ENTRIES : MIN_CHILDREN)) {
+            refreshSlot(in, i);
+            return;
+        }
+        
+        int a = i > 0 ? i - 1 : i;
+        int capacity = c->leaf ? LeafCapacity : Fanout;
+        if (in->child[a]->count + in->child[a + 1]->count <= capacity) {
+            merge(in, a);
+            refreshSlot(in, a);
+        } else {
+            if (a == i) {
+                borrowFromRight(in, a);
+            } else {
+                borrowFromLeft(in, a);
+            }
+            refreshSlot(in, a);
+            refreshSlot(in, a + 1);
+        }
+    }
+    
+    void merge(Inner* in, int a) {
+        int b = a + 1;
+        if (in->child[a]->leaf) {
+            Leaf* la = static_cast<Leaf*>(in->child[a]);
+            Leaf* lb = static_cast<Leaf*>(in->child[b]);
+            copyEntries(lb, 0, lb->count, la, la->count);
+            la->count += lb->count;
+            la->next = lb->next;
+            leafPool.destroy(lb);
+        } else {
+            Inner* ia = static_cast<Inner*>(in->child[a]);
+            Inner* ib = static_cast<Inner*>(in->child[b]);
+            ia->seps[ia->count - 1] = in->seps[a];
+            std::copy(ib->seps, ib->seps + ib->count - 1, ia->seps + ia->count);
+            std::copy(ib->child, ib->child + ib->count, ia->child + ia->count);
+            std::copy(ib->sizes, ib->sizes + ib->count, ia->sizes + ia->count);
+            std::copy(ib->sums, ib->sums + ib->count, ia->sums + ia->count);
+            std::copy(ib->maxprefs, ib->maxprefs + ib->count, ia->maxprefs + ia->count);
+            std::copy(ib->argmaxes, ib->argmaxes + ib->count, ia->argmaxes + ia->count);
+            ia->count += ib->count;
+            innerPool.destroy(ib);
+        }
+        
+        removeSlot(in, b);
+        std::copy(in->seps + b, in->seps + in->count, in->seps + a);
+    }
+    
+    // Drop slot b (child pointer and aggregates, not separators)
+    static void removeSlot(Inner* in, int b) {
+        std::copy(in->child + b + 1, in->child + in->count, in->child + b);
+        std::copy(in->sizes + b + 1, in->sizes + in->count, in->sizes + b);
+        std::copy(in->sums + b + 1, in->sums + in->count, in->sums + b);
+        std::copy(in->maxprefs + b + 1, in->maxprefs + in->count, in->maxprefs + b);
+        std::copy(in->argmaxes + b + 1, in->argmaxes + in->count, in->argmaxes + b);
+        in->count--;
+    }
+    
+    static void copySlot(const Inner* src, int from, Inner* dst, int to) {
+        dst->child[to] = src->child[from];
+        dst->sizes[to] = src->sizes[from];
+        dst->sums[to] = src->sums[from];
+        dst->maxprefs[to] = src->maxprefs[from];
+        dst->argmaxes[to] = src->argmaxes[from];
+    }
+    
+    void borrowFromRight(Inner* in, int a) {
+        int b = a + 1;
+        if (in->child[a]->leaf) {
+            Leaf* la = static_cast<Leaf*>(in->child[a]);
+            Leaf* lb = static_cast<Leaf*>(in->child[b]);
+            copyEntries(lb, 0, 1, la, la->count);
+            la->count++;
+            closeGap(lb, 0);
+            in->seps[a] = la->starts[la->count - 1];
+        } else {
+            Inner* ia = static_cast<Inner*>(in->child[a]);
+            Inner* ib = static_cast<Inner*>(in->child[b]);
+            ia->seps[ia->count - 1] = in->seps[a];
+            copySlot(ib, 0, ia, ia->count);
+            ia->count++;
+            in->seps[a] = ib->seps[0];
+            std::copy(ib->seps + 1, ib->seps + ib->count - 1, ib->seps);
+            removeSlot(ib, 0);
+        }
+    }
+    
+    void borrowFromLeft(Inner* in, int a) {
+        int b = a + 1;
+        if (in->child[a]->leaf) {
+            Leaf* la = static_cast<Leaf*>(in->child[a]);
+            Leaf* lb = static_cast<Leaf*>(in->child[b]);
+            openGap(lb, 0);
+            copyEntries(la, la->count - 1, 1, lb, 0);
+            la->count--;
+            in->seps[a] = la->starts[la->count - 1];
+        } else {
+            Inner* ia = static_cast<Inner*>(in->child[a]);
+            Inner* ib = static_cast<Inner*>(in->child[b]);
+            for (int j = ib->count; j > 0; j--) {
+                copySlot(ib, j - 1, ib, j);
+            }
+            std::copy_backward(ib->seps, ib->seps + ib->count - 1, ib->seps + ib->count);
+            copySlot(ia, ia->count - 1, ib, 0);
+            ib->seps[0] = in->seps[a];
+            ib->count++;
+            in->seps[a] = ia->seps[ia->count - 2];
+            ia->count--;
+        }
+    }
+    
+    // Global 1-indexed position of the first interval matching (start,
+    // end), or -1
+    int findPosition(const Interval& iv) const {
+        int less = 0;
+        const Node* node = root;
+        while (!node->leaf) {
+            const Inner* in = static_cast<const Inner*>(node);
+            int i = childFor(in, iv.start);
+            for (int j = 0; j < i; j++) {
+                less += in->sizes[j];
+            }
+            node = in->child[i];
+        }
+        
+        // Equal starts may continue into the following leaves
+        const Leaf* leaf = static_cast<const Leaf*>(node);
+        int pos = lowerBound(leaf, iv.start);
+        while (leaf != nullptr) {
+            for (; pos < leaf->count; pos++) {
+                if (leaf->starts[pos] != iv.start) return -1;
+                if (leaf->ends[pos] == iv.end) return less + pos + 1;
+            }
+            less += leaf->count;
+            leaf = leaf->next;
+            pos = 0;
+        }
+        return -1;
+    }
+
+public:
+    BlockedPOMTree() : root(leafPool.create()), total(0) {}
+    
+    BlockedPOMTree(const BlockedPOMTree&) = delete;
+    BlockedPOMTree& operator=(const BlockedPOMTree&) = delete;
+    
+    void clear() {
+        leafPool.release();
+        innerPool.release();
+        root = leafPool.create();
+        rootData = AugmentedData();
+        total = 0;
+    }
+    
+    void insert(Interval interval) {
+        int sep;
+        Node* split = insertInto(root, interval, sep);
+        if (split != nullptr) {
+            Inner* top = innerPool.create();
+            top->child[0] = root;
+            top->child[1] = split;
+            top->seps[0] = sep;
+            top->count = 2;
+            refreshAll(top);
+            root = top;
+        }
+        total++;
+        rootData = computeData(root);
+    }
+    
+    // Remove one interval with the same start and end, if present
+    void remove(Interval interval) {
+        int k = findPosition(interval);
+        if (k == -1) return;
+        
+        eraseFrom(root, k);
+        total--;
+        if (!root->leaf && root->count == 1) {
+            Inner* old = static_cast<Inner*>(root);
+            root = old->child[0];
+            innerPool.destroy(old);
+        }
+        rootData = computeData(root);
+    }
+    
+    AugmentedData findPOM() const {
+        return rootData;
+    }
+    
+    long long getSum() const {
+        return rootData.sum;
+    }
+    
+    std::size_t size() const {
+        return total;
+    }
+    
+    bool empty() const {
+        return total == 0;
+    }
+};
+
+#endif // POM_BLOCKED_H
@@ -0,0 +1,246 @@
+#ifndef POM_PERSISTENT_H
+#define POM_PERSISTENT_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include "pom.h"
+
+/**
+ * Persistent POM Tree (path copying)
+ * An immutable version of the interval set with the same augmented data
+ * as POMTree (sum, maxpref, argmax). insert and remove leave the version
+ * they are called on untouched and return a new one:
+ * - only the O(log n) nodes on the search path are copied; every other
+ *   subtree is shared between the old and the new version
+ * - nodes are immutable once published and reference counted, so a
+ *   version handle is a single pointer to copy, any number of threads may
+ *   query it concurrently without locks, and a node is freed when the
+ *   last version using it goes away
+ *
+ * Balance comes from a treap: each node draws a random priority and the
+ * tree is heap-ordered on it, giving O(log n) expected depth without
+ * rotations that would have to copy extra nodes. Order and duplicate
+ * handling match POMTree: intervals are ordered by start, equal starts
+ * keep insertion order, and remove deletes one interval with the same
+ * start and end (missing intervals are ignored, returning the same
+ * version).
+ *
+ * As with any shared_ptr, reading one handle object while another thread
+ * assigns to that same object is a race; give each thread its own copy.
+ */
+
+class PersistentPOMTree {
+private:
+    struct Node;
+    using Link = std::shared_ptr<const Node>;
+    
+    struct Node {
+        Interval interval;
+        std::uint64_t priority;
+        AugmentedData data;
+        int size;
+        Link left;
+        Link right;
+        
+        Node(const Interval& interval, std::uint64_t priority, Link left, Link right)
+            : interval(interval), priority(priority), size(1 + sizeOf(left) + sizeOf(right)),
+              left(std::move(left)), right(std::move(right)) {
+            data = POMTree::combine(POMTree::combine(dataOf(this->left), POMTree::single(interval)),
+                                    dataOf(this->right));
+        }
+    };
+    
+    Link root;
+    
+    explicit PersistentPOMTree(Link root) : root(std::move(root)) {}
+    
+    static int sizeOf(const Link& t) {
+        return t ? t->size : 0;
+    }
+    
+    static AugmentedData dataOf(const Link& t) {
+        return t ? t->data : AugmentedData();
+    }
+    
+    // splitmix64 over a shared counter: distinct, well mixed priorities
+    // for nodes created from any thread
+    static std::uint64_t nextPriority() {
+        static std::atomic<std::uint64_t> counter(0);
+        std::uint64_t z = counter.fetch_add(1, std::memory_order_relaxed) * 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+    
+    static Link makeNode(const Node& copy, Link left, Link right) {
+        return std::make_shared<const Node>(copy.interval, copy.priority,
+                                            std::move(left), std::move(right));
+    }
+    
+    // Split t into starts <= key and starts > key, copying the split path
+    static void split(const Link& t, int key, Link& l, Link& r) {
+        if (!t) {
+            l = r = nullptr;
+            return;
+        }
+        if (t->interval.start <= key) {
+            Link mid;
+            split(t->right, key, mid, r);
+            l = makeNode(*t, t->left, std::move(mid));
+        } else {
+            Link mid;
+            split(t->left, key, l, mid);
+            r = makeNode(*t, std::move(mid), t->right);
+        }
+    }
+    
+    // Concatenate l and r, where every interval of l precedes r
+    static Link merge(const Link& l, const Link& r) {
+        if (!l) return r;
+        if (!r) return l;
+        if (l->priority > r->priority) {
+            return makeNode(*l, l->left, merge(l->right, r));
+        }
+        return makeNode(*r, merge(l, r->left), r->right);
+    }
+    
+    static Link insertInto(const Link& t, const Interval& interval, std::uint64_t priority) {
+        if (!t || priority > t->priority) {
+            Link l, r;
+            split(t, interval.start, l, r);
+            return std::make_shared<const Node>(interval, priority, std::move(l), std::move(r));
+        }
+        // Equal starts go right, after the intervals already present
+        if (interval.start < t->interval.start) {
+            return makeNode(*t, insertInto(t->left, interval, priority), t->right);
+        }
+        return makeNode(*t, t->left, insertInto(t->right, interval, priority));
+    }
+    
+    // Copy the path to the first matching interval and drop it; returns t
+    // itself (nothing copied) if there is no match. Equal starts may sit
+    // on both sides of a node, so those subtrees are searched in order.
+    static Link eraseFrom(const Link& t, const Interval& interval, bool& removed) {
+        if (!t) return t;
+        if (interval.start < t->interval.start) {
+            Link left = eraseFrom(t->left, interval, removed);
+            return removed ? makeNode(*t, std::move(left), t->right) : t;
+        }
+        if (t->interval.start < interval.start) {
+            Link right = eraseFrom(t->right, interval, removed);
+            return removed ? makeNode(*t, t->left, std::move(right)) : t;
+        }
+        
+        Link left = eraseFrom(t->left, interval, removed);
+        if (removed) return makeNode(*t, std::move(left), t->right);
+        if (t->interval.end == interval.end) {
+            removed = true;
+            return merge(t->left, t->right);
+        }
+        Link right = eraseFrom(t->right, interval, removed);
+        return removed ? makeNode(*t, t->left, std::move(right)) : t;
+    }
+    
+    // Data for intervals in subtree x with start >= a
+    static AugmentedData suffixFrom(const Node* x, int a) {
+        AugmentedData acc;
+        while (x != nullptr) {
+            if (x->interval.start >= a) {
+                acc = POMTree::combine(POMTree::combine(POMTree::single(x->interval),
+                                                        dataOf(x->right)), acc);
+                x = x->left.get();
+            } else {
+                x = x->right.get();
+            }
+        }
+        return acc;
+    }
+    
+    // Data for intervals in subtree x with start < b
+    static AugmentedData prefixBefore(const Node* x, int b) {
+        AugmentedData acc;
+        while (x != nullptr) {
+            if (x->interval.start < b) {
+                acc = POMTree::combine(acc, POMTree::combine(dataOf(x->left),
+                                                             POMTree::single(x->interval)));
+                x = x->right.get();
+            } else {
+                x = x->left.get();
+            }
+        }
+        return acc;
+    }
+
+public:
+    // The empty version
+    PersistentPOMTree() = default;
+    
+    // New version with interval added; O(log n) expected time and nodes
+    PersistentPOMTree insert(const Interval& interval) const {
+        return PersistentPOMTree(insertInto(root, interval, nextPriority()));
+    }
+    
+    // New version with one interval matching start and end removed
+    PersistentPOMTree remove(const Interval& interval) const {
+        bool removed = false;
+        Link next = eraseFrom(root, interval, removed);
+        return removed ? PersistentPOMTree(std::move(next)) : *this;
+    }
+    
+    // Find maximum prefix sum and its position
+    AugmentedData findPOM() const {
+        return dataOf(root);
+    }
+    
+    // Maximum prefix sum over intervals with start in [a, b), in O(log n)
+    AugmentedData findPOM(int a, int b) const {
+        const Node* x = root.get();
+        while (x != nullptr) {
+            if (x->interval.start < a) {
+                x = x->right.get();
+            } else if (x->interval.start >= b) {
+                x = x->left.get();
+            } else {
+                return POMTree::combine(POMTree::combine(suffixFrom(x->left.get(), a),
+                                                         POMTree::single(x->interval)),
+                                        prefixBefore(x->right.get(), b));
+            }
+        }
+        return AugmentedData();
+    }
+    
+    // Sum of values of all intervals with start <= x, in O(log n)
+    long long prefixSumAt(int x) const {
+        long long sum = 0;
+        const Node* node = root.get();
+        while (node != nullptr) {
+            if (node->interval.start <= x) {
+                sum += dataOf(node->left).sum + node->interval.value;
+                node = node->right.get();
+            } else {
+                node = node->left.get();
+            }
+        }
+        return sum;
+    }
+    
+    long long getSum() const {
+        return dataOf(root).sum;
+    }
+    
+    std::size_t size() const {
+        return sizeOf(root);
+    }
+    
+    bool empty() const {
+        return !root;
+    }
+    
+    // True if both handles are the same version (not just equal contents)
+    bool sameVersion(const PersistentPOMTree& other) const {
+        return root == other.root;
+    }
+};
+
+#endif // POM_PERSISTENT_H
@@ -0,0 +1,381 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <algorithm>
+#include <climits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+/**
+ * SIMD scan kernels for blocked trees
+ * Small-array scans that wide-node trees run inside a node:
+ * - rankSlot: first slot whose running count reaches k (the child or
+ *   entry holding the k-th element), k reduced to the rank inside it
+ * - maxPrefix: sum, maximum prefix sum and its first position over a
+ *   block of int values (a POM leaf block)
+ * - maxPrefixCombine: the same over per-child (sum, maxpref) pairs, i.e.
+ *   max_i(sum of children before i + maxpref_i)
+ *
+ * Each kernel has a scalar version and x86 versions compiled with target
+ * attributes, so no global -mavx2 is needed. The best level the CPU
+ * supports is picked at first use (AVX2, then SSE, then scalar);
+ * setLevel() forces a lower one for benchmarking. The SSE level covers
+ * rankSlot (SSE2) and maxPrefix (SSE4.2); maxPrefixCombine has no SSE
+ * version and uses the scalar one there.
+ *
+ * Ties in maxPrefix/maxPrefixCombine resolve to the earliest position,
+ * matching POMTree::combine.
+ */
+
+namespace simd {
+
+enum SimdLevel { SIMD_SCALAR, SIMD_SSE, SIMD_AVX2 };
+
+struct PrefixMax {
+    long long sum;
+    long long maxpref;   // LLONG_MIN for an empty block
+    int argmax;          // Position in the block, -1 for an empty block
+    
+    PrefixMax() : sum(0), maxpref(LLONG_MIN), argmax(-1) {}
+};
+
+// ---- Scalar kernels ----
+
+inline int rankSlotScalar(const int* counts, int n, int& k) {
+    int i = 0;
+    while (i < n && k > counts[i]) {
+        k -= counts[i];
+        i++;
+    }
+    return i;
+}
+
+inline PrefixMax maxPrefixScalar(const int* values, int n) {
+    PrefixMax r;
+    for (int i = 0; i < n; i++) {
+        r.sum += values[i];
+        bool better = r.sum > r.maxpref;
+        r.maxpref = better ? r.sum : r.maxpref;
+        r.argmax = better ? i : r.argmax;
+    }
+    return r;
+}
+
+inline PrefixMax maxPrefixCombineScalar(const long long* sums, const long long* maxprefs, int n) {
+    PrefixMax r;
+    for (int i = 0; i < n; i++) {
+        long long candidate = r.sum + maxprefs[i];
+        if (candidate > r.maxpref) {
+            r.maxpref = candidate;
+            r.argmax = i;
+        }
+        r.sum += sums[i];
+    }
+    return r;
+}
+
+#ifdef SIMD_X86
+
+// ---- SSE kernels ----
+
+__attribute__((target("sse2")))
+inline int rankSlotSSE(const int* counts, int n, int& k) {
+    int base = 0;
+    int i = 0;
+    __m128i limit = _mm_set1_epi32(k - 1);
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(counts + i));
+        v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+        v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+        v = _mm_add_epi32(v, _mm_set1_epi32(base));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(v, limit)));
+        if (mask != 0) {
+            alignas(16) int prefix[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(prefix), v);
+            int j = __builtin_ctz(mask);
+            k -= j > 0 ? prefix[j - 1] : base;
+            return i + j;
+        }
+        base = _mm_cvtsi128_si32(_mm_shuffle_epi32(v, 0xFF));
+    }
+    k -= base;
+    return i + rankSlotScalar(counts + i, n - i, k);
+}
+
+__attribute__((target("sse4.2")))
+inline PrefixMax maxPrefixSSE(const int* values, int n) {
+    __m128i base = _mm_setzero_si128();
+    __m128i best = _mm_set1_epi64x(LLONG_MIN);
+    __m128i bestIdx = _mm_set1_epi64x(-1);
+    __m128i idx = _mm_set_epi64x(1, 0);
+    __m128i step = _mm_set1_epi64x(2);
+    int i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i x = _mm_cvtepi32_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(values + i)));
+        __m128i local = _mm_add_epi64(x, _mm_slli_si128(x, 8));
+        x = _mm_add_epi64(local, base);
+        __m128i gt = _mm_cmpgt_epi64(x, best);
+        best = _mm_blendv_epi8(best, x, gt);
+        bestIdx = _mm_blendv_epi8(bestIdx, idx, gt);
+        base = _mm_add_epi64(base, _mm_unpackhi_epi64(local, local));
+        idx = _mm_add_epi64(idx, step);
+    }
+    
+    alignas(16) long long lanes[2], lanesIdx[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), best);
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanesIdx), bestIdx);
+    PrefixMax r;
+    r.sum = _mm_cvtsi128_si64(base);
+    for (int j = 0; j < 2; j++) {
+        if (lanesIdx[j] >= 0 && (lanes[j] > r.maxpref ||
+                                 (lanes[j] == r.maxpref && lanesIdx[j] < r.argmax))) {
+            r.maxpref = lanes[j];
+            r.argmax = (int)lanesIdx[j];
+        }
+    }
+    for (; i < n; i++) {
+        r.sum += values[i];
+        if (r.sum > r.maxpref) {
+            r.maxpref = r.sum;
+            r.argmax = i;
+        }
+    }
+    return r;
+}
+
+// ---- AVX2 kernels ----
+
+__attribute__((target("avx2")))
+inline int rankSlotAVX2(const int* counts, int n, int& k) {
+    int base = 0;
+    int i = 0;
+    __m256i limit = _mm256_set1_epi32(k - 1);
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(counts + i));
+        // Prefix inside each 128-bit half, then carry the low half's total
+        v = _mm256_add_epi32(v, _mm256_slli_si256(v, 4));
+        v = _mm256_add_epi32(v, _mm256_slli_si256(v, 8));
+        __m256i carry = _mm256_permutevar8x32_epi32(v, _mm256_set1_epi32(3));
+        v = _mm256_add_epi32(v, _mm256_blend_epi32(_mm256_setzero_si256(), carry, 0xF0));
+        v = _mm256_add_epi32(v, _mm256_set1_epi32(base));
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(v, limit)));
+        if (mask != 0) {
+            alignas(32) int prefix[8];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(prefix), v);
+            int j = __builtin_ctz(mask);
+            k -= j > 0 ? prefix[j - 1] : base;
+            return i + j;
+        }
+        base = _mm256_extract_epi32(v, 7);
+    }
+    k -= base;
+    return i + rankSlotSSE(counts + i, n - i, k);
+}
+
+// Inclusive prefix sum across the four 64-bit lanes of x
+__attribute__((target("avx2")))
+inline __m256i prefix4x64(__m256i x) {
+    __m256i zero = _mm256_setzero_si256();
+    x = _mm256_add_epi64(x, _mm256_blend_epi32(_mm256_permute4x64_epi64(x, 0x90), zero, 0x03));
+    x = _mm256_add_epi64(x, _mm256_blend_epi32(_mm256_permute4x64_epi64(x, 0x40), zero, 0x0F));
+    return x;
+}
+
+// Fold the per-lane best candidates into r (earliest position on ties)
+__attribute__((target("avx2")))
+inline void reduceBest(__m256i best, __m256i bestIdx, PrefixMax& r) {
+    alignas(32) long long lanes[4], lanesIdx[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), best);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanesIdx), bestIdx);
+    for (int j = 0; j < 4; j++) {
+        if (lanesIdx[j] >= 0 && (lanes[j] > r.maxpref ||
+                                 (lanes[j] == r.maxpref && lanesIdx[j] < r.argmax))) {
+            r.maxpref = lanes[j];
+            r.argmax = (int)lanesIdx[j];
+        }
+    }
+}
+
+// Widen four ints at p to 64-bit lanes
+__attribute__((target("avx2")))
+inline __m256i load4x64(const int* p) {
+    return _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+}
+
+// First position in [0, n) (n a multiple of 4) whose prefix sum is target
+__attribute__((target("avx2")))
+inline int firstPrefixEqual(const int* values, int n, long long target) {
+    __m256i base = _mm256_setzero_si256();
+    __m256i want = _mm256_set1_epi64x(target);
+    for (int i = 0; i < n; i += 4) {
+        __m256i local = prefix4x64(load4x64(values + i));
+        __m256i eq = _mm256_cmpeq_epi64(_mm256_add_epi64(local, base), want);
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(eq));
+        if (mask != 0) return i + __builtin_ctz(mask);
+        base = _mm256_add_epi64(base, _mm256_permute4x64_epi64(local, 0xFF));
+    }
+    return -1;
+}
+
+// Two passes: the first finds the maximum with two independent running
+// maxima and only adds on the carried sum, the second finds where it
+// first occurs. Tracking the position in the first pass would put a
+// compare-and-blend on the critical path of every step.
+__attribute__((target("avx2")))
+inline PrefixMax maxPrefixAVX2(const int* values, int n) {
+    int blocks = n & ~3;
+    __m256i base = _mm256_setzero_si256();
+    __m256i bestA = _mm256_set1_epi64x(LLONG_MIN);
+    __m256i bestB = bestA;
+    int i = 0;
+    for (; i + 8 <= blocks; i += 8) {
+        __m256i la = prefix4x64(load4x64(values + i));
+        __m256i lb = prefix4x64(load4x64(values + i + 4));
+        __m256i xa = _mm256_add_epi64(la, base);
+        __m256i mid = _mm256_add_epi64(base, _mm256_permute4x64_epi64(la, 0xFF));
+        __m256i xb = _mm256_add_epi64(lb, mid);
+        base = _mm256_add_epi64(mid, _mm256_permute4x64_epi64(lb, 0xFF));
+        bestA = _mm256_blendv_epi8(bestA, xa, _mm256_cmpgt_epi64(xa, bestA));
+        bestB = _mm256_blendv_epi8(bestB, xb, _mm256_cmpgt_epi64(xb, bestB));
+    }
+    if (i < blocks) {
+        __m256i la = prefix4x64(load4x64(values + i));
+        __m256i xa = _mm256_add_epi64(la, base);
+        base = _mm256_add_epi64(base, _mm256_permute4x64_epi64(la, 0xFF));
+        bestA = _mm256_blendv_epi8(bestA, xa, _mm256_cmpgt_epi64(xa, bestA));
+    }
+    
+    __m256i best = _mm256_blendv_epi8(bestA, bestB, _mm256_cmpgt_epi64(bestB, bestA));
+    alignas(32) long long lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), best);
+    PrefixMax r;
+    r.sum = _mm256_extract_epi64(base, 0);
+    r.maxpref = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+    if (blocks > 0) {
+        r.argmax = firstPrefixEqual(values, blocks, r.maxpref);
+    }
+    for (i = blocks; i < n; i++) {
+        r.sum += values[i];
+        if (r.sum > r.maxpref) {
+            r.maxpref = r.sum;
+            r.argmax = i;
+        }
+    }
+    return r;
+}
+
+__attribute__((target("avx2")))
+inline PrefixMax maxPrefixCombineAVX2(const long long* sums, const long long* maxprefs, int n) {
+    __m256i base = _mm256_setzero_si256();
+    __m256i best = _mm256_set1_epi64x(LLONG_MIN);
+    __m256i bestIdx = _mm256_set1_epi64x(-1);
+    __m256i idx = _mm256_set_epi64x(3, 2, 1, 0);
+    __m256i step = _mm256_set1_epi64x(4);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sums + i));
+        __m256i local = prefix4x64(s);
+        __m256i before = _mm256_add_epi64(_mm256_sub_epi64(local, s), base);
+        __m256i x = _mm256_add_epi64(before, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(maxprefs + i)));
+        __m256i gt = _mm256_cmpgt_epi64(x, best);
+        best = _mm256_blendv_epi8(best, x, gt);
+        bestIdx = _mm256_blendv_epi8(bestIdx, idx, gt);
+        base = _mm256_add_epi64(base, _mm256_permute4x64_epi64(local, 0xFF));
+        idx = _mm256_add_epi64(idx, step);
+    }
+    
+    PrefixMax r;
+    r.sum = _mm256_extract_epi64(base, 0);
+    reduceBest(best, bestIdx, r);
+    for (; i < n; i++) {
+        long long candidate = r.sum + maxprefs[i];
+        if (candidate > r.maxpref) {
+            r.maxpref = candidate;
+            r.argmax = i;
+        }
+        r.sum += sums[i];
+    }
+    return r;
+}
+
+#endif // SIMD_X86
+
+// ---- Runtime dispatch ----
+
+struct Kernels {
+    SimdLevel level;
+    int (*rankSlot)(const int*, int, int&);
+    PrefixMax (*maxPrefix)(const int*, int);
+    PrefixMax (*maxPrefixCombine)(const long long*, const long long*, int);
+};
+
+inline SimdLevel detectLevel() {
+#ifdef SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+    if (__builtin_cpu_supports("sse4.2")) return SIMD_SSE;
+#endif
+    return SIMD_SCALAR;
+}
+
+inline Kernels kernelsFor(SimdLevel level) {
+    Kernels k = {SIMD_SCALAR, rankSlotScalar, maxPrefixScalar, maxPrefixCombineScalar};
+#ifdef SIMD_X86
+    if (level >= SIMD_SSE) {
+        k.level = SIMD_SSE;
+        k.rankSlot = rankSlotSSE;
+        k.maxPrefix = maxPrefixSSE;
+    }
+    if (level >= SIMD_AVX2) {
+        k.level = SIMD_AVX2;
+        k.rankSlot = rankSlotAVX2;
+        k.maxPrefix = maxPrefixAVX2;
+        k.maxPrefixCombine = maxPrefixCombineAVX2;
+    }
+#else
+    (void)level;
+#endif
+    return k;
+}
+
+inline Kernels& active() {
+    static Kernels kernels = kernelsFor(detectLevel());
+    return kernels;
+}
+
+inline SimdLevel level() {
+    return active().level;
+}
+
+// Use at most `requested` (clamped to what the CPU supports)
+inline void setLevel(SimdLevel requested) {
+    SimdLevel supported = detectLevel();
+    active() = kernelsFor(requested < supported ? requested : supported);
+}
+
+inline const char* levelName(SimdLevel level) {
+    switch (level) {
+        case SIMD_AVX2: return "avx2";
+        case SIMD_SSE: return "sse";
+        default: return "scalar";
+    }
+}
+
+inline int rankSlot(const int* counts, int n, int& k) {
+    return active().rankSlot(counts, n, k);
+}
+
+inline PrefixMax maxPrefix(const int* values, int n) {
+    return active().maxPrefix(values, n);
+}
+
+inline PrefixMax maxPrefixCombine(const long long* sums, const long long* maxprefs, int n) {
+    return active().maxPrefixCombine(sums, maxprefs, n);
+}
+
+} // namespace simd
+
+#endif // SIMD_H
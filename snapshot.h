@@ -0,0 +1,414 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "ost.h"
+#include "pom.h"
+
+/**
+ * Memory-mapped snapshots of OrderStatisticTree and POMTree
+ * A snapshot file is written with one sequential pass over a tree and
+ * loaded by mmap with no parsing: the sections are used in place, so
+ * opening costs a header check and queries page the file in on demand.
+ * - OSTSnapshot: the keys in order; select is one array load and
+ *   rank/rankOf are binary searches
+ * - POMSnapshot: the intervals by start, their inclusive prefix sums and
+ *   an implicit max tree over those sums (the bottom-up segment-tree
+ *   layout, 2n indices), so findPOM(a, b) is two binary searches plus an
+ *   O(log n) range-argmax, and prefixSumAt is one binary search
+ *
+ * A snapshot is read-only. toTree() turns it into a mutable tree in O(n)
+ * through the bulk sorted build, with no descents or rebalancing, so a
+ * service can answer reads from the mapping at once and convert only
+ * when the first write arrives.
+ *
+ * Layout (native byte order; every section starts on a 64-byte boundary):
+ *   SnapshotHeader | section 0 | section 1 | ...
+ * Keys, intervals, prefix sums and indices are stored as raw arrays, so
+ * files are not portable across byte orders or key types; the header
+ * records the kind and element size and opening a mismatched file throws.
+ */
+
+enum SnapshotKind { SNAPSHOT_OST = 1, SNAPSHOT_POM = 2 };
+
+struct SnapshotHeader {
+    char magic[8];              // "AUGSNAP" plus a terminating zero
+    std::uint32_t formatVersion;
+    std::uint32_t kind;         // SnapshotKind
+    std::uint64_t elementSize;  // sizeof(key) or sizeof(Interval)
+    std::uint64_t count;        // Number of elements
+};
+
+// Read-only mapping of a whole file, unmapped on destruction
+class MappedFile {
+private:
+    const char* bytes;
+    std::size_t length;
+
+public:
+    explicit MappedFile(const std::string& path) : bytes(nullptr), length(0) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("snapshot: cannot open " + path);
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(SnapshotHeader)) {
+            ::close(fd);
+            throw std::runtime_error("snapshot: truncated file " + path);
+        }
+        length = (std::size_t)info.st_size;
+        void* p = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);  // The mapping keeps the file alive
+        if (p == MAP_FAILED) {
+            throw std::runtime_error("snapshot: cannot map " + path);
+        }
+        bytes = static_cast<const char*>(p);
+    }
+    
+    ~MappedFile() {
+        if (bytes != nullptr) ::munmap(const_cast<char*>(bytes), length);
+    }
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    MappedFile(MappedFile&& other) noexcept : bytes(other.bytes), length(other.length) {
+        other.bytes = nullptr;
+        other.length = 0;
+    }
+    
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        std::swap(bytes, other.bytes);
+        std::swap(length, other.length);
+        return *this;
+    }
+    
+    const char* data() const { return bytes; }
+    std::size_t size() const { return length; }
+};
+
+namespace snapshot_detail {
+
+const std::uint32_t FORMAT_VERSION = 1;
+const std::size_t ALIGNMENT = 64;
+
+inline std::size_t alignUp(std::size_t offset) {
+    return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+// Offsets of consecutive sections of the given byte sizes
+inline std::vector<std::size_t> sectionOffsets(const std::vector<std::size_t>& sizes) {
+    std::vector<std::size_t> offsets;
+    std::size_t at = alignUp(sizeof(SnapshotHeader));
+    for (std::size_t bytes : sizes) {
+        offsets.push_back(at);
+        at = alignUp(at + bytes);
+    }
+    offsets.push_back(at);  // End of file
+    return offsets;
+}
+
+inline SnapshotHeader makeHeader(SnapshotKind kind, std::size_t elementSize, std::size_t count) {
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "AUGSNAP", 8);
+    header.formatVersion = FORMAT_VERSION;
+    header.kind = kind;
+    header.elementSize = elementSize;
+    header.count = count;
+    return header;
+}
+
+// Sequential, buffered writer that pads every section to the alignment
+class Writer {
+private:
+    std::ofstream out;
+    std::string path;
+    std::size_t offset;
+    
+    void pad() {
+        static const char zeros[ALIGNMENT] = {};
+        std::size_t aligned = alignUp(offset);
+        out.write(zeros, aligned - offset);
+        offset = aligned;
+    }
+
+public:
+    Writer(const std::string& path, const SnapshotHeader& header)
+        : out(path, std::ios::binary | std::ios::trunc), path(path), offset(0) {
+        if (!out) {
+            throw std::runtime_error("snapshot: cannot create " + path);
+        }
+        write(&header, sizeof(header));
+        pad();
+    }
+    
+    void write(const void* p, std::size_t bytes) {
+        out.write(static_cast<const char*>(p), bytes);
+        offset += bytes;
+    }
+    
+    // End the current section
+    void endSection() {
+        pad();
+    }
+    
+    void finish() {
+        out.flush();
+        if (!out) {
+            throw std::runtime_error("snapshot: write failed for " + path);
+        }
+    }
+};
+
+// Map path and check that it holds `kind` with sections of these sizes
+// (computed from the header count by sizesFor)
+template<typename SizesFor>
+const SnapshotHeader& validate(const MappedFile& file, SnapshotKind kind, std::size_t elementSize,
+                               SizesFor sizesFor, std::vector<std::size_t>& offsets) {
+    const SnapshotHeader& header = *reinterpret_cast<const SnapshotHeader*>(file.data());
+    if (std::memcmp(header.magic, "AUGSNAP", 8) != 0 || header.formatVersion != FORMAT_VERSION) {
+        throw std::runtime_error("snapshot: not a snapshot file");
+    }
+    if (header.kind != (std::uint32_t)kind || header.elementSize != elementSize) {
+        throw std::runtime_error("snapshot: wrong tree kind or element type");
+    }
+    offsets = sectionOffsets(sizesFor((std::size_t)header.count));
+    if (file.size() < offsets.back()) {
+        throw std::runtime_error("snapshot: truncated file");
+    }
+    return header;
+}
+
+} // namespace snapshot_detail
+
+/**
+ * Snapshot of an OrderStatisticTree: one section holding the n keys in
+ * order. T must be trivially copyable.
+ */
+template<typename T, typename SizeT = int>
+class OSTSnapshot {
+    static_assert(std::is_trivially_copyable<T>::value, "snapshot keys are stored as raw bytes");
+
+private:
+    MappedFile file;
+    const T* keys;
+    SizeT count;
+    
+    static std::vector<std::size_t> sizesFor(std::size_t n) {
+        return std::vector<std::size_t>(1, n * sizeof(T));
+    }
+
+public:
+    using value_type = T;
+    using size_type = SizeT;
+    
+    // Write tree's keys to path in one in-order pass
+    static void write(const std::string& path, OrderStatisticTree<T, SizeT>& tree) {
+        snapshot_detail::Writer out(path, snapshot_detail::makeHeader(SNAPSHOT_OST, sizeof(T),
+                                                                      (std::size_t)tree.size()));
+        std::vector<T> buffer;
+        buffer.reserve(4096);
+        tree.forEach([&](const T& key) {
+            buffer.push_back(key);
+            if (buffer.size() == buffer.capacity()) {
+                out.write(buffer.data(), buffer.size() * sizeof(T));
+                buffer.clear();
+            }
+        });
+        out.write(buffer.data(), buffer.size() * sizeof(T));
+        out.endSection();
+        out.finish();
+    }
+    
+    // Map a file from write(); throws std::runtime_error if it does not
+    // hold keys of this type
+    explicit OSTSnapshot(const std::string& path) : file(path) {
+        std::vector<std::size_t> offsets;
+        const SnapshotHeader& header = snapshot_detail::validate(file, SNAPSHOT_OST, sizeof(T),
+                                                                 sizesFor, offsets);
+        keys = reinterpret_cast<const T*>(file.data() + offsets[0]);
+        count = (SizeT)header.count;
+    }
+    
+    // Find k-th smallest element (1-indexed)
+    T select(SizeT k) const {
+        if (k < 1 || k > count) {
+            throw std::out_of_range("Index out of range");
+        }
+        return keys[k - 1];
+    }
+    
+    // Rank of the first element equal to key (1-indexed), -1 if absent
+    SizeT rank(const T& key) const {
+        const T* it = std::lower_bound(keys, keys + count, key);
+        if (it == keys + count || key < *it) return -1;
+        return (SizeT)(it - keys) + 1;
+    }
+    
+    // 1 + number of elements < key (lower_bound position)
+    SizeT rankOf(const T& key) const {
+        return (SizeT)(std::lower_bound(keys, keys + count, key) - keys) + 1;
+    }
+    
+    // Mutable copy, built in O(n) from the mapped keys
+    OrderStatisticTree<T, SizeT> toTree() const {
+        return OrderStatisticTree<T, SizeT>(keys, keys + count);
+    }
+    
+    const T* begin() const { return keys; }
+    const T* end() const { return keys + count; }
+    SizeT size() const { return count; }
+    bool empty() const { return count == 0; }
+};
+
+/**
+ * Snapshot of a POMTree. Sections: intervals[n] by start, prefix[n] with
+ * prefix[i] = value[0] + ... + value[i], and best[2n], where best[n + i] = i
+ * and best[j] is whichever of best[2j] and best[2j + 1] has the larger
+ * prefix (the earlier one on ties, as POMTree's argmax).
+ */
+class POMSnapshot {
+private:
+    MappedFile file;
+    const Interval* intervals;
+    const long long* prefix;
+    const std::int32_t* best;
+    int count;
+    
+    static std::vector<std::size_t> sizesFor(std::size_t n) {
+        return {n * sizeof(Interval), n * sizeof(long long), 2 * n * sizeof(std::int32_t)};
+    }
+    
+    static bool better(const long long* prefix, std::int32_t a, std::int32_t b) {
+        return prefix[a] > prefix[b] || (prefix[a] == prefix[b] && a < b);
+    }
+    
+    // First index whose start is >= key
+    int lowerIndex(int key) const {
+        return (int)(std::lower_bound(intervals, intervals + count, key,
+                                      [](const Interval& iv, int k) { return iv.start < k; }) - intervals);
+    }
+    
+    // Position of the maximum prefix in [l, r), earliest on ties; l < r
+    std::int32_t argmaxIn(int l, int r) const {
+        std::int32_t result = l;
+        for (l += count, r += count; l < r; l >>= 1, r >>= 1) {
+            if (l & 1) {
+                std::int32_t c = best[l++];
+                if (better(prefix, c, result)) result = c;
+            }
+            if (r & 1) {
+                std::int32_t c = best[--r];
+                if (better(prefix, c, result)) result = c;
+            }
+        }
+        return result;
+    }
+
+public:
+    // Write tree's intervals to path in one in-order pass. The prefix sums
+    // and the max tree are kept in memory (12 bytes per interval) so the
+    // file itself is still written front to back.
+    static void write(const std::string& path, POMTree& tree) {
+        std::size_t n = tree.size();
+        snapshot_detail::Writer out(path, snapshot_detail::makeHeader(SNAPSHOT_POM, sizeof(Interval), n));
+        
+        std::vector<long long> sums;
+        sums.reserve(n);
+        std::vector<Interval> buffer;
+        buffer.reserve(4096);
+        long long running = 0;
+        tree.forEach([&](const Interval& iv) {
+            running += iv.value;
+            sums.push_back(running);
+            buffer.push_back(iv);
+            if (buffer.size() == buffer.capacity()) {
+                out.write(buffer.data(), buffer.size() * sizeof(Interval));
+                buffer.clear();
+            }
+        });
+        out.write(buffer.data(), buffer.size() * sizeof(Interval));
+        out.endSection();
+        out.write(sums.data(), n * sizeof(long long));
+        out.endSection();
+        
+        std::vector<std::int32_t> maxTree(2 * n);
+        for (std::size_t i = 0; i < n; i++) {
+            maxTree[n + i] = (std::int32_t)i;
+        }
+        for (std::size_t j = n; j-- > 1; ) {
+            std::int32_t a = maxTree[2 * j], b = maxTree[2 * j + 1];
+            maxTree[j] = better(sums.data(), b, a) ? b : a;
+        }
+        out.write(maxTree.data(), maxTree.size() * sizeof(std::int32_t));
+        out.endSection();
+        out.finish();
+    }
+    
+    // Map a file from write(); throws std::runtime_error if it is not a
+    // POM snapshot
+    explicit POMSnapshot(const std::string& path) : file(path) {
+        std::vector<std::size_t> offsets;
+        const SnapshotHeader& header = snapshot_detail::validate(file, SNAPSHOT_POM, sizeof(Interval),
+                                                                 sizesFor, offsets);
+        intervals = reinterpret_cast<const Interval*>(file.data() + offsets[0]);
+        prefix = reinterpret_cast<const long long*>(file.data() + offsets[1]);
+        best = reinterpret_cast<const std::int32_t*>(file.data() + offsets[2]);
+        count = (int)header.count;
+    }
+    
+    // Find maximum prefix sum and its position
+    AugmentedData findPOM() const {
+        if (count == 0) return AugmentedData();
+        std::int32_t j = count > 1 ? best[1] : 0;
+        return AugmentedData(prefix[count - 1], prefix[j], intervals[j].start);
+    }
+    
+    // Maximum prefix sum over intervals with start in [a, b), as
+    // POMTree::findPOM(a, b)
+    AugmentedData findPOM(int a, int b) const {
+        int l = lowerIndex(a);
+        int r = std::max(l, lowerIndex(b));
+        if (l == r) return AugmentedData();
+        long long base = l > 0 ? prefix[l - 1] : 0;
+        std::int32_t j = argmaxIn(l, r);
+        return AugmentedData(prefix[r - 1] - base, prefix[j] - base, intervals[j].start);
+    }
+    
+    // Sum of values of all intervals with start <= x
+    long long prefixSumAt(int x) const {
+        int r = (int)(std::upper_bound(intervals, intervals + count, x,
+                                       [](int k, const Interval& iv) { return k < iv.start; }) - intervals);
+        return r > 0 ? prefix[r - 1] : 0;
+    }
+    
+    long long getSum() const {
+        return count > 0 ? prefix[count - 1] : 0;
+    }
+    
+    // Mutable copy, built in O(n) from the mapped intervals
+    POMTree toTree(POMUpdateMode mode = POM_INCREMENTAL) const {
+        POMTree tree(mode);
+        tree.buildFromSorted(intervals, intervals + count);
+        return tree;
+    }
+    
+    const Interval* begin() const { return intervals; }
+    const Interval* end() const { return intervals + count; }
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+};
+
+#endif // SNAPSHOT_H
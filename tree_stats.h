@@ -0,0 +1,172 @@
+#ifndef TREE_STATS_H
+#define TREE_STATS_H
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+/**
+ * Tree Statistics (compile-time optional)
+ * Hot-path counters for OrderStatisticTree and POMTree, switched on by
+ * building with -DTREE_STATS (see `make stats`). Without the macro the
+ * hooks below expand to nothing and the trees carry no extra member, so
+ * the normal build is unchanged.
+ *
+ * Counts are kept per operation type. Each public operation opens a scope
+ * naming its type; work done outside any scope (bulk build, batch relink,
+ * split/join) is charged to TREE_OP_OTHER. Scopes do not nest: when one
+ * operation is implemented by another (remove via erase, a small batch
+ * via insert) the outer one is the call that gets counted.
+ *
+ * Depth is the number of nodes an operation's descents visited, so the
+ * average depth is nodesVisited / calls and maxDepth is the largest single
+ * call. "Augment updates" are summary recomputations for trees with a
+ * monoid summary (POMTree) and size recomputations for size-only trees
+ * like OrderStatisticTree (rotations refresh sizes inline).
+ */
+
+enum TreeOp {
+    TREE_OP_INSERT,
+    TREE_OP_REMOVE,
+    TREE_OP_SELECT,
+    TREE_OP_RANK,
+    TREE_OP_QUERY,
+    TREE_OP_UPDATE,
+    TREE_OP_OTHER,
+    TREE_OP_COUNT
+};
+
+struct TreeOpStats {
+    unsigned long long calls = 0;
+    unsigned long long leftRotations = 0;
+    unsigned long long rightRotations = 0;
+    unsigned long long insertFixupIterations = 0;
+    unsigned long long deleteFixupIterations = 0;
+    unsigned long long nodesVisited = 0;
+    unsigned long long augmentUpdates = 0;
+    unsigned long long maxDepth = 0;
+    
+    double avgDepth() const {
+        return calls == 0 ? 0.0 : (double)nodesVisited / calls;
+    }
+    
+    bool touched() const {
+        return calls != 0 || leftRotations != 0 || rightRotations != 0 ||
+               nodesVisited != 0 || augmentUpdates != 0;
+    }
+    
+    TreeOpStats& operator+=(const TreeOpStats& other) {
+        calls += other.calls;
+        leftRotations += other.leftRotations;
+        rightRotations += other.rightRotations;
+        insertFixupIterations += other.insertFixupIterations;
+        deleteFixupIterations += other.deleteFixupIterations;
+        nodesVisited += other.nodesVisited;
+        augmentUpdates += other.augmentUpdates;
+        maxDepth = std::max(maxDepth, other.maxDepth);
+        return *this;
+    }
+};
+
+struct TreeStats {
+    TreeOpStats ops[TREE_OP_COUNT];
+    TreeOp active = TREE_OP_OTHER;  // Operation currently being counted
+    
+    TreeOpStats& current() {
+        return ops[active];
+    }
+    
+    const TreeOpStats& operator[](TreeOp op) const {
+        return ops[op];
+    }
+    
+    void reset() {
+        for (TreeOpStats& s : ops) {
+            s = TreeOpStats();
+        }
+    }
+    
+    TreeStats& operator+=(const TreeStats& other) {
+        for (int i = 0; i < TREE_OP_COUNT; i++) {
+            ops[i] += other.ops[i];
+        }
+        return *this;
+    }
+    
+    static const char* opName(TreeOp op) {
+        static const char* const names[TREE_OP_COUNT] = {
+            "insert", "remove", "select", "rank", "query", "update", "other"
+        };
+        return names[op];
+    }
+    
+    // One row per operation type that did any work
+    void print(std::ostream& os, const std::string& indent = "  ") const {
+        os << indent << std::left << std::setw(8) << "op" << std::right
+           << std::setw(10) << "calls"
+           << std::setw(10) << "rotL"
+           << std::setw(10) << "rotR"
+           << std::setw(10) << "insFix"
+           << std::setw(10) << "delFix"
+           << std::setw(12) << "visited"
+           << std::setw(12) << "augment"
+           << std::setw(9) << "avgDep"
+           << std::setw(8) << "maxDep" << "\n";
+        for (int i = 0; i < TREE_OP_COUNT; i++) {
+            const TreeOpStats& s = ops[i];
+            if (!s.touched()) continue;
+            os << indent << std::left << std::setw(8) << opName((TreeOp)i) << std::right
+               << std::setw(10) << s.calls
+               << std::setw(10) << s.leftRotations
+               << std::setw(10) << s.rightRotations
+               << std::setw(10) << s.insertFixupIterations
+               << std::setw(10) << s.deleteFixupIterations
+               << std::setw(12) << s.nodesVisited
+               << std::setw(12) << s.augmentUpdates
+               << std::setw(9) << std::fixed << std::setprecision(2) << s.avgDepth()
+               << std::setw(8) << s.maxDepth << "\n";
+        }
+    }
+};
+
+// Charges everything until the end of the enclosing block to one
+// operation type, then records that call's depth
+class TreeStatsScope {
+private:
+    TreeStats& stats;
+    bool outermost;
+    unsigned long long visitedBefore;
+
+public:
+    TreeStatsScope(TreeStats& stats, TreeOp op)
+        : stats(stats), outermost(stats.active == TREE_OP_OTHER), visitedBefore(0) {
+        if (outermost) {
+            stats.active = op;
+            visitedBefore = stats.current().nodesVisited;
+        }
+    }
+    
+    ~TreeStatsScope() {
+        if (!outermost) return;
+        TreeOpStats& s = stats.current();
+        s.calls++;
+        s.maxDepth = std::max(s.maxDepth, s.nodesVisited - visitedBefore);
+        stats.active = TREE_OP_OTHER;
+    }
+    
+    TreeStatsScope(const TreeStatsScope&) = delete;
+    TreeStatsScope& operator=(const TreeStatsScope&) = delete;
+};
+
+// Hooks used inside the trees; each tree declares a `treeStats` member
+// under the same macro
+#ifdef TREE_STATS
+#define TREE_STATS_SCOPE(op) TreeStatsScope treeStatsScope_(treeStats, op)
+#define TREE_STATS_COUNT(counter) (treeStats.current().counter++)
+#else
+#define TREE_STATS_SCOPE(op) ((void)0)
+#define TREE_STATS_COUNT(counter) ((void)0)
+#endif
+
+#endif // TREE_STATS_H
@@ -0,0 +1,322 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include "ost.h"
+#include "pom.h"
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+/**
+ * Workload generators for the OST/POM benchmarks
+ * Produces a reproducible stream of insert/remove/select/rank operations
+ * over distinct int keys, plus the keys to preload before the stream:
+ * - WORKLOAD_UNIFORM: random keys, removes and queries at uniform ranks
+ * - WORKLOAD_ZIPF: keys drawn Zipfian (hot keys scattered over the key
+ *   space); removes and queries land on the live key nearest a hot key
+ * - WORKLOAD_REVERSE: every insert is a new minimum, removes take the
+ *   maximum (the mirror image of the old monotonic benchmarks)
+ * - WORKLOAD_SLIDING_WINDOW: inserts append a new maximum; once the
+ *   window is full, the next write drops the oldest (minimum) key
+ *
+ * readPercent of the operations are queries (split evenly between select
+ * and rank); the rest are writes. All randomness comes from a seeded
+ * splitmix64 stream, so a config generates the same workload everywhere.
+ * Generation keeps an OrderStatisticTree model of the live keys, so every
+ * remove names a present key and every select a valid rank.
+ */
+
+enum WorkloadPattern {
+    WORKLOAD_UNIFORM,
+    WORKLOAD_ZIPF,
+    WORKLOAD_REVERSE,
+    WORKLOAD_SLIDING_WINDOW
+};
+
+enum WorkloadOpType {
+    WORKLOAD_INSERT,
+    WORKLOAD_REMOVE,
+    WORKLOAD_SELECT,   // key holds a 1-indexed rank
+    WORKLOAD_RANK
+};
+
+struct WorkloadOp {
+    WorkloadOpType type;
+    int key;
+    
+    WorkloadOp(WorkloadOpType t, int k) : type(t), key(k) {}
+};
+
+struct WorkloadConfig {
+    WorkloadPattern pattern;
+    int initialSize;
+    int operations;
+    int readPercent;        // 0..100
+    int keySpace;           // Keys in [0, keySpace); 0 picks 4 * (initial + ops) + 1
+    double zipfSkew;        // Exponent s of P(k) ~ 1 / k^s
+    int window;             // Sliding window size; 0 uses initialSize
+    std::uint64_t seed;
+    
+    WorkloadConfig(WorkloadPattern pattern = WORKLOAD_UNIFORM, int initialSize = 10000,
+                   int operations = 10000, int readPercent = 50, std::uint64_t seed = 42)
+        : pattern(pattern), initialSize(initialSize), operations(operations),
+          readPercent(readPercent), keySpace(0), zipfSkew(0.99), window(0), seed(seed) {}
+};
+
+struct Workload {
+    std::vector<int> initial;        // Keys to insert first, in this order
+    std::vector<WorkloadOp> ops;
+};
+
+class WorkloadGenerator {
+private:
+    std::uint64_t state;
+    std::vector<double> zipfCdf;
+    std::uint64_t zipfMult;     // Odd multiplier coprime to the key space
+    
+    std::uint64_t next() {
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+    
+    // Uniform in [0, n)
+    int below(int n) {
+        return (int)(next() % (std::uint64_t)n);
+    }
+    
+    double unit() {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+    
+    void buildZipf(int n, double s) {
+        zipfCdf.resize(n);
+        double total = 0;
+        for (int k = 1; k <= n; k++) {
+            total += 1.0 / std::pow((double)k, s);
+            zipfCdf[k - 1] = total;
+        }
+        for (double& c : zipfCdf) {
+            c /= total;
+        }
+        zipfMult = 2654435761ULL;
+        while (std::gcd(zipfMult, (std::uint64_t)n) != 1) {
+            zipfMult += 2;
+        }
+    }
+    
+    // Zipf popularity rank in [0, n), scattered over [0, n) by a fixed
+    // multiplicative permutation so hot keys are not all small
+    int zipfKey(int n) {
+        int r = (int)(std::lower_bound(zipfCdf.begin(), zipfCdf.end(), unit()) - zipfCdf.begin());
+        r = std::min(r, n - 1);
+        return (int)(((std::uint64_t)r * zipfMult) % (std::uint64_t)n);
+    }
+    
+    // First absent key at or after `key`, wrapping around the key space
+    static int freeKeyFrom(OrderStatisticTree<int>& live, int key, int keySpace) {
+        while (live.rank(key) != -1) {
+            key = (key + 1) % keySpace;
+        }
+        return key;
+    }
+    
+    // Rank of the live key nearest `key` from above, wrapping to the first
+    static int rankNear(OrderStatisticTree<int>& live, int key) {
+        int r = live.rankOf(key);
+        return r > live.size() ? 1 : r;
+    }
+
+public:
+    explicit WorkloadGenerator(std::uint64_t seed) : state(seed), zipfMult(1) {}
+    
+    Workload generate(const WorkloadConfig& config) {
+        if (config.initialSize < 0 || config.operations < 0 ||
+            config.readPercent < 0 || config.readPercent > 100) {
+            throw std::invalid_argument("Invalid workload config");
+        }
+        
+        int keySpace = config.keySpace > 0 ? config.keySpace
+                                           : 4 * (config.initialSize + config.operations) + 1;
+        int window = config.window > 0 ? config.window : std::max(1, config.initialSize);
+        if (keySpace <= config.initialSize + config.operations &&
+            config.pattern != WORKLOAD_SLIDING_WINDOW) {
+            throw std::invalid_argument("Key space too small for workload");
+        }
+        if (config.pattern == WORKLOAD_ZIPF) {
+            buildZipf(keySpace, config.zipfSkew);
+        }
+        
+        Workload w;
+        w.initial.reserve(config.initialSize);
+        w.ops.reserve(config.operations);
+        OrderStatisticTree<int> live;
+        
+        // Monotonic patterns hand out keys from counters
+        int low = keySpace - 1;     // Next key for REVERSE (descending)
+        int high = 0;               // Next key for SLIDING_WINDOW (ascending)
+        
+        auto freshKey = [&]() {
+            switch (config.pattern) {
+                case WORKLOAD_REVERSE:
+                    return low--;
+                case WORKLOAD_SLIDING_WINDOW:
+                    return high++;
+                case WORKLOAD_ZIPF:
+                    return freeKeyFrom(live, zipfKey(keySpace), keySpace);
+                default:
+                    return freeKeyFrom(live, below(keySpace), keySpace);
+            }
+        };
+        
+        for (int i = 0; i < config.initialSize; i++) {
+            int key = freshKey();
+            live.insert(key);
+            w.initial.push_back(key);
+        }
+        
+        for (int i = 0; i < config.operations; i++) {
+            bool read = below(100) < config.readPercent && !live.empty();
+            
+            if (read) {
+                int r = config.pattern == WORKLOAD_ZIPF ? rankNear(live, zipfKey(keySpace))
+                                                        : below(live.size()) + 1;
+                if (next() & 1) {
+                    w.ops.push_back(WorkloadOp(WORKLOAD_SELECT, r));
+                } else {
+                    w.ops.push_back(WorkloadOp(WORKLOAD_RANK, live.select(r)));
+                }
+                continue;
+            }
+            
+            // Writes insert and remove evenly; the sliding window removes
+            // exactly when it is full so the live set stays at `window`
+            bool insert;
+            if (config.pattern == WORKLOAD_SLIDING_WINDOW) {
+                insert = live.size() < window;
+            } else {
+                insert = live.empty() || (next() & 1);
+            }
+            
+            if (insert) {
+                int key = freshKey();
+                live.insert(key);
+                w.ops.push_back(WorkloadOp(WORKLOAD_INSERT, key));
+                continue;
+            }
+            
+            int r;
+            switch (config.pattern) {
+                case WORKLOAD_REVERSE:
+                    r = live.size();
+                    break;
+                case WORKLOAD_SLIDING_WINDOW:
+                    r = 1;
+                    break;
+                case WORKLOAD_ZIPF:
+                    r = rankNear(live, zipfKey(keySpace));
+                    break;
+                default:
+                    r = below(live.size()) + 1;
+                    break;
+            }
+            int key = live.select(r);
+            live.remove(key);
+            w.ops.push_back(WorkloadOp(WORKLOAD_REMOVE, key));
+        }
+        return w;
+    }
+    
+    static Workload make(const WorkloadConfig& config) {
+        WorkloadGenerator gen(config.seed);
+        return gen.generate(config);
+    }
+    
+    static const char* patternName(WorkloadPattern pattern) {
+        switch (pattern) {
+            case WORKLOAD_UNIFORM: return "uniform";
+            case WORKLOAD_ZIPF: return "zipf";
+            case WORKLOAD_REVERSE: return "reverse";
+            case WORKLOAD_SLIDING_WINDOW: return "sliding_window";
+        }
+        return "unknown";
+    }
+};
+
+/**
+ * Workload drivers
+ * Replay a workload's operation stream against a tree; the returned
+ * checksum folds in every query answer, so backends can be cross-checked
+ * and benchmark loops cannot drop the queries.
+ *
+ * replayOrderStatistic works with any backend exposing the OST API
+ * (insert/remove/select/rankOf). replayPOM maps key k to the interval
+ * [10k, 10k + 10) with a value in [-10, 9] derived from k; select runs
+ * findPOM() and rank runs prefixSumAt() at the interval start.
+ */
+
+inline Interval workloadInterval(int key) {
+    return Interval(key * 10, key * 10 + 10, (int)(((unsigned)key * 2654435761u) >> 16) % 20 - 10);
+}
+
+template<typename Tree>
+void loadOrderStatistic(Tree& tree, const Workload& w) {
+    for (int key : w.initial) {
+        tree.insert(key);
+    }
+}
+
+template<typename Tree>
+long long replayOrderStatistic(Tree& tree, const Workload& w) {
+    long long checksum = 0;
+    for (const WorkloadOp& op : w.ops) {
+        switch (op.type) {
+            case WORKLOAD_INSERT:
+                tree.insert(op.key);
+                break;
+            case WORKLOAD_REMOVE:
+                tree.remove(op.key);
+                break;
+            case WORKLOAD_SELECT:
+                checksum += tree.select(op.key);
+                break;
+            case WORKLOAD_RANK:
+                checksum += tree.rankOf(op.key);
+                break;
+        }
+    }
+    return checksum;
+}
+
+inline void loadPOM(POMTree& pom, const Workload& w) {
+    for (int key : w.initial) {
+        pom.insert(workloadInterval(key));
+    }
+}
+
+inline long long replayPOM(POMTree& pom, const Workload& w) {
+    long long checksum = 0;
+    for (const WorkloadOp& op : w.ops) {
+        switch (op.type) {
+            case WORKLOAD_INSERT:
+                pom.insert(workloadInterval(op.key));
+                break;
+            case WORKLOAD_REMOVE:
+                pom.remove(workloadInterval(op.key));
+                break;
+            case WORKLOAD_SELECT:
+                checksum += pom.findPOM().maxpref;
+                break;
+            case WORKLOAD_RANK:
+                checksum += pom.prefixSumAt(op.key * 10);
+                break;
+        }
+    }
+    return checksum;
+}
+
+#endif // WORKLOAD_H